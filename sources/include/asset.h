@@ -0,0 +1,68 @@
+#ifndef ASSET_H
+#define ASSET_H
+
+#include <SDL/SDL.h>
+
+/**
+ * @brief Create an empty asset cache.
+ * @return A pointer to the newly created asset cache.
+ */
+struct asset_cache *asset_cache_new(void);
+
+/**
+ * @brief Free the asset cache and every image still resident in it.
+ * @param cache A pointer to the asset cache to be freed.
+ */
+void asset_cache_free(struct asset_cache *cache);
+
+/**
+ * @brief Load an image through the cache.
+ *
+ * Images are keyed by path and by content hash, so a file loaded twice, or two files
+ * with the same content, are decoded only once and share the same surface.
+ *
+ * @param cache A pointer to the asset cache.
+ * @param filename The path to the image file.
+ * @return The shared SDL surface, with one more reference.
+ * @note If the image loading fails, it raises an error.
+ */
+SDL_Surface *asset_cache_load(struct asset_cache *cache, const char *filename);
+
+/**
+ * @brief Decode a set of images in parallel, ahead of their loading.
+ *
+ * The files are spread across a pool of worker threads, each reading, hashing and
+ * decoding one file after the other, so that file reads overlap image decodes.
+ * The function returns once every image is decoded. The images are kept in the
+ * cache without any reference until asset_cache_load is called on them.
+ *
+ * @param cache A pointer to the asset cache.
+ * @param filenames The paths to the image files.
+ * @param num_filenames The number of paths.
+ * @note If an image can't be read or decoded, it raises an error once every worker is done.
+ */
+void asset_cache_preload(struct asset_cache *cache, const char **filenames, int num_filenames);
+
+/**
+ * @brief Release a reference to an image loaded through the cache.
+ * The surface is freed when its last reference is released.
+ * @param cache A pointer to the asset cache.
+ * @param surface The surface returned by asset_cache_load.
+ */
+void asset_cache_release(struct asset_cache *cache, SDL_Surface *surface);
+
+/**
+ * @brief Get the number of decoded images resident in the cache.
+ * @param cache A pointer to the asset cache.
+ * @return The number of resident images.
+ */
+int asset_cache_get_num_assets(struct asset_cache *cache);
+
+/**
+ * @brief Get the memory used by the pixels and the file content of the images resident in the cache.
+ * @param cache A pointer to the asset cache.
+ * @return The resident memory in bytes.
+ */
+size_t asset_cache_get_resident_memory(struct asset_cache *cache);
+
+#endif /* ASSET_H */
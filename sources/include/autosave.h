@@ -0,0 +1,57 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include "buffer.h"
+
+/**
+ * @brief Start a thread writing saves to a file in the background.
+ * A whole save goes to a temporary file, synced to the disk then renamed over the file: the file always holds
+ * a whole save, the previous one until the new one is written. The changes since then are appended to it.
+ * @param filename The path to the save file.
+ * @return A pointer to the newly created autosave.
+ */
+struct autosave *autosave_new(const char *filename);
+
+/**
+ * @brief Wait for the save being written, stop the thread and free the memory occupied by the autosave.
+ * @param autosave A pointer to the autosave to be freed.
+ */
+void autosave_free(struct autosave *autosave);
+
+/**
+ * @brief Get the buffer to fill with the next save, once the previous one is written.
+ * @param autosave A pointer to the autosave.
+ * @param wait 1 to wait for the previous save, 0 to give up while it is being written.
+ * @return The cleared buffer, or NULL if the previous save is still being written and wait is 0.
+ */
+struct buffer *autosave_begin(struct autosave *autosave, int wait);
+
+/**
+ * @brief Hand the buffer got from autosave_begin to the thread, which writes it to the file.
+ * The buffer must not be used until the next call to autosave_begin.
+ * @param autosave A pointer to the autosave.
+ * @param append 1 to append the buffer to the file, 0 to replace the file with it.
+ */
+void autosave_commit(struct autosave *autosave, int append);
+
+/**
+ * @brief Tell whether the file holds a whole save written by the thread, which changes can be appended to.
+ * Only called between autosave_begin and autosave_commit.
+ * @param autosave A pointer to the autosave.
+ * @return 1 if the last whole save and the changes appended since were written, 0 otherwise.
+ */
+int autosave_has_base(struct autosave *autosave);
+
+/**
+ * @brief Wait until the last save committed is on the disk.
+ * @param autosave A pointer to the autosave.
+ */
+void autosave_flush(struct autosave *autosave);
+
+/**
+ * @brief Wait for the save being written and remove the save file.
+ * @param autosave A pointer to the autosave.
+ */
+void autosave_discard(struct autosave *autosave);
+
+#endif /* AUTOSAVE_H */
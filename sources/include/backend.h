@@ -0,0 +1,98 @@
+#ifndef BACKEND_H
+#define BACKEND_H
+
+#include <SDL/SDL.h>
+
+struct game;
+struct snapshot;
+
+/**
+ * @enum action
+ * @brief Represents the commands given to the game, whatever the input they come from.
+ */
+enum action {
+    ACTION_NONE = 0, /**< No more command for the current game tick */
+    ACTION_NORTH, /**< Move the player north */
+    ACTION_SOUTH, /**< Move the player south */
+    ACTION_EAST, /**< Move the player east */
+    ACTION_WEST, /**< Move the player west */
+    ACTION_BOMB, /**< Drop a bomb */
+    ACTION_OPEN, /**< Open the door the player is looking toward */
+    ACTION_PAUSE, /**< Pause or resume the game */
+    ACTION_SAVE, /**< Save the game and quit */
+    ACTION_QUIT, /**< Quit the game */
+    ACTION_BACK, /**< Pause the game and rewind it by a second */
+    ACTION_FORWARD, /**< Pause the game and step it forward by a second, after rewinding it */
+    NUM_ACTIONS /**< Number of actions, not an action */
+};
+
+/**
+ * @brief Structure describing a render backend: how the game is displayed and where its commands come from.
+ * The backend is opened, pumped, displayed and closed from the main thread, while its commands are polled
+ * from the thread running the game.
+ */
+struct backend {
+    Uint32 subsystems; /**< SDL subsystems to initialize before opening the backend */
+    int frame_rate; /**< Frames drawn per second, 0 to run the game ticks as fast as possible */
+
+    /**
+     * @brief Open the backend for a game.
+     * @param game A pointer to the game.
+     * @param argument The optional argument of the backend given on the command line, NULL if none.
+     * @return The state of the backend, given back to the other functions.
+     */
+    void *(*open)(struct game *game, const char *argument);
+
+    /**
+     * @brief Close the backend, freeing its state.
+     */
+    void (*close)(void *data);
+
+    /**
+     * @brief Display a snapshot of the game.
+     * @param alpha The elapsed fraction of the game tick following the snapshot, from 0 to 1.
+     */
+    void (*display)(void *data, const struct snapshot *snapshot, double alpha);
+
+    /**
+     * @brief Read the input that must be read from the main thread, keeping the commands for the game.
+     */
+    void (*pump)(void *data);
+
+    /**
+     * @brief Get the next command for the current game tick.
+     * @param time The time the command was read, in microseconds of get_monotonic_time.
+     * @return The next command, ACTION_NONE when there is no more for this tick.
+     */
+    enum action (*poll)(void *data, Uint64 *time);
+};
+
+/**
+ * @brief Backend drawing the game in an SDL window and reading the keyboard.
+ * Its argument is the size of a cell in pixels, fitted to the desktop when missing.
+ */
+extern const struct backend sdl_backend;
+
+/**
+ * @brief Backend drawing nothing, without any window nor sprite, and reading the commands from a script.
+ * Its argument is the path to the script, the standard input when missing, and no script at all when empty.
+ * Each line of the script gives the commands of a game tick, separated by spaces, and the game quits at
+ * the end of the script.
+ */
+extern const struct backend null_backend;
+
+/**
+ * @brief Backend drawing the game with characters in a terminal, only sending what changed since the last frame.
+ * Its argument is the path to the terminal, the standard output when missing. The keyboard is only read from
+ * the terminal the game was started from.
+ */
+extern const struct backend terminal_backend;
+
+/**
+ * @brief Get the action with a name, as written in scripts.
+ * @param name The name of the action: UP, DOWN, RIGHT, LEFT, BOMB, OPEN, PAUSE, SAVE, QUIT, BACK or FORWARD.
+ * @return The action, ACTION_NONE if no action has this name.
+ */
+enum action backend_get_action(const char *name);
+
+#endif /* BACKEND_H */
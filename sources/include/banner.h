@@ -0,0 +1,34 @@
+#ifndef BANNER_H
+#define BANNER_H
+
+#include "snapshot.h"
+#include "camera.h"
+#include "render.h"
+#include "sprites.h"
+
+/**
+ * @brief Create the banner displayed below the map.
+ * @return A pointer to the newly created banner.
+ */
+struct banner *banner_new(void);
+
+/**
+ * @brief Free the memory occupied by the banner.
+ * @param banner A pointer to the banner to be freed.
+ */
+void banner_free(struct banner *banner);
+
+/**
+ * @brief Display the banner below the visible part of the map.
+ * The banner is composited into a surface of its own, drawn again only when one of its values,
+ * its width or the tile size changes, and then blitted in a single call.
+ * Numbers of several digits are drawn with smaller digits, in the place of a single one.
+ * @param banner A pointer to the banner.
+ * @param queue The render queue of the frame.
+ * @param sprites The sprites of the game.
+ * @param camera The camera giving the visible part of the map.
+ * @param snapshot The snapshot giving the current level and the counters of the player.
+ */
+void banner_display(struct banner *banner, struct render_queue *queue, struct sprites *sprites, struct camera *camera, const struct snapshot *snapshot);
+
+#endif /* BANNER_H */
@@ -0,0 +1,97 @@
+#ifndef BLIT_H
+#define BLIT_H
+
+#include "sprites.h"
+#include <SDL/SDL.h>
+
+/**
+ * @enum blit_isa
+ * @brief Represents the instruction sets the blit kernels are written for.
+ */
+enum blit_isa {
+    BLIT_C, /**< Portable C */
+    BLIT_SSE2, /**< x86 SSE2, 4 pixels at once */
+    BLIT_AVX2 /**< x86 AVX2, 8 pixels at once */
+};
+
+/**
+ * @brief Select the kernels of the best instruction set supported by the CPU.
+ * Until then, the portable C kernels are used.
+ */
+void blit_init(void);
+
+/**
+ * @brief Check if the CPU supports the kernels of an instruction set.
+ * @param isa The instruction set.
+ * @return 1 if the kernels can run, 0 otherwise.
+ */
+int blit_is_isa_supported(enum blit_isa isa);
+
+/**
+ * @brief Select the kernels of an instruction set.
+ * Must not be called while blits are running on other threads.
+ * @param isa The instruction set.
+ * @return 1 if the kernels are selected, 0 if the CPU doesn't support them.
+ */
+int blit_set_isa(enum blit_isa isa);
+
+/**
+ * @brief Get the instruction set of the kernels in use.
+ * @return The instruction set.
+ */
+enum blit_isa blit_get_isa(void);
+
+/**
+ * @brief Get the name of an instruction set.
+ * @param isa The instruction set.
+ * @return The name of the instruction set.
+ */
+const char *blit_get_isa_name(enum blit_isa isa);
+
+/**
+ * @brief Check if a surface can be drawn by the blit functions into another one.
+ *
+ * Both surfaces must have 32 bits per pixel and the same color channels. The source must either
+ * be opaque or have an alpha channel in its high byte, without color key nor surface alpha.
+ *
+ * @param source The surface to draw.
+ * @param destination The surface to draw in.
+ * @return 1 if the blit functions support the pair of surfaces, 0 otherwise.
+ */
+int blit_is_supported(SDL_Surface *source, SDL_Surface *destination);
+
+/**
+ * @brief Draw a sprite in a surface, inside a clipping area only.
+ *
+ * The pixels are blended with the formula of SDL's software blitter, so the result is
+ * the same as SDL_BlitSurface whatever the instruction set of the kernels.
+ * The destination must be locked if it needs to be.
+ * Blits with disjoint clipping areas can run on different threads at the same time.
+ *
+ * @param destination The surface to draw in.
+ * @param clip The area of the destination which may be modified.
+ * @param sprite The sprite to draw, supported by blit_is_supported.
+ * @param x The x-coordinate of the sprite in the destination.
+ * @param y The y-coordinate of the sprite in the destination.
+ */
+void blit_sprite(SDL_Surface *destination, const SDL_Rect *clip, struct sprite *sprite, int x, int y);
+
+/**
+ * @brief Set every pixel of an area of a 32 bits per pixel surface to a color.
+ * @param destination The surface to fill.
+ * @param area The area to fill, inside the surface.
+ * @param color The color, in the format of the surface.
+ */
+void blit_fill(SDL_Surface *destination, const SDL_Rect *area, Uint32 color);
+
+/**
+ * @brief Compare the blit kernels of every supported instruction set with SDL_BlitSurface on tiles.
+ * Each kernel is also checked to draw the same pixels as SDL_BlitSurface.
+ * @param opaque_sprite The sprite of the opaque tile.
+ * @param alpha_sprite The sprite of the tile with an alpha channel.
+ * @param window The window to blit the tiles in.
+ * @param iterations Number of blits of each tile.
+ */
+void blit_benchmark(struct sprite *opaque_sprite, struct sprite *alpha_sprite, SDL_Surface *window, int iterations);
+
+#endif /* BLIT_H */
@@ -3,6 +3,7 @@
 
 #include "cell_types.h"
 #include "../include/direction.h"
+#include "buffer.h"
 #include <stdio.h>
 
 /**
@@ -21,18 +22,32 @@ struct bomb_node *bomb_node_new(int x, int y, int range);
 void bomb_node_free(struct bomb_node *bomb_node);
 
 /**
- * @brief Write a bomb node to a file.
+ * @brief Write a bomb node to a buffer, in a compact form which doesn't depend on the platform.
  * @param bomb_node The bomb node to write.
- * @param file The file to write the bomb node to.
+ * @param buffer The buffer to write the bomb node to.
  */
-void bomb_node_write(struct bomb_node *bomb_node, FILE *file);
+void bomb_node_serialize(struct bomb_node *bomb_node, struct buffer *buffer);
 
 /**
- * @brief Read a bomb node from a file.
- * @param file The file to read the bomb node from.
- * @return A pointer to the bomb_node read.
+ * @brief Read a bomb node written by bomb_node_serialize.
+ * @param buffer The buffer to read the bomb node from.
+ * @return A pointer to the bomb node read.
  */
-struct bomb_node *bomb_node_read(FILE *file);
+struct bomb_node *bomb_node_deserialize(struct buffer *buffer);
+
+/**
+ * @brief Copy a bomb node to a checkpoint, as it is in memory. Only read back by this process.
+ * @param bomb_node The bomb node to copy.
+ * @param buffer The buffer to copy the bomb node to.
+ */
+void bomb_node_checkpoint(struct bomb_node *bomb_node, struct buffer *buffer);
+
+/**
+ * @brief Restore a bomb node copied by bomb_node_checkpoint, in place: it keeps its timer and its place in the list.
+ * @param bomb_node The bomb node to restore.
+ * @param buffer The buffer to read the bomb node from.
+ */
+void bomb_node_rollback(struct bomb_node *bomb_node, struct buffer *buffer);
 
 /**
  * @brief Get the next bomb node in the linked list of bombs.
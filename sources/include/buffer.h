@@ -0,0 +1,158 @@
+#ifndef BUFFER_H
+#define BUFFER_H
+
+#include <SDL/SDL.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * @brief Create an empty buffer of bytes, growing as values are written to it.
+ * The values are written as varints, the same on every platform, and read back in the same order.
+ * @return A pointer to the newly created buffer.
+ */
+struct buffer *buffer_new(void);
+
+/**
+ * @brief Free the memory occupied by the buffer.
+ * @param buffer A pointer to the buffer to be freed.
+ */
+void buffer_free(struct buffer *buffer);
+
+/**
+ * @brief Empty the buffer, keeping its memory, and read it again from its start.
+ * @param buffer A pointer to the buffer.
+ */
+void buffer_clear(struct buffer *buffer);
+
+/**
+ * @brief Read the buffer again from its first byte.
+ * @param buffer A pointer to the buffer.
+ */
+void buffer_rewind(struct buffer *buffer);
+
+/**
+ * @brief Get the bytes written to the buffer.
+ * @param buffer A pointer to the buffer.
+ * @return The bytes of the buffer.
+ */
+const unsigned char *buffer_get_data(const struct buffer *buffer);
+
+/**
+ * @brief Get the number of bytes written to the buffer.
+ * @param buffer A pointer to the buffer.
+ * @return The size of the buffer in bytes.
+ */
+size_t buffer_get_size(const struct buffer *buffer);
+
+/**
+ * @brief Get the number of bytes already read from the buffer.
+ * @param buffer A pointer to the buffer.
+ * @return The position of the next value to read.
+ */
+size_t buffer_get_position(const struct buffer *buffer);
+
+/**
+ * @brief Skip bytes of the buffer without reading them.
+ * Skipping past the end of the buffer raises an error.
+ * @param buffer A pointer to the buffer.
+ * @param size The number of bytes to skip.
+ */
+void buffer_skip(struct buffer *buffer, size_t size);
+
+/**
+ * @brief Get a checksum of bytes of the buffer, a CRC-32.
+ * @param buffer A pointer to the buffer.
+ * @param start The index of the first byte to check.
+ * @param size The number of bytes to check.
+ * @return The checksum of the bytes.
+ */
+Uint32 buffer_get_checksum(const struct buffer *buffer, size_t start, size_t size);
+
+/**
+ * @brief Write the rest of a file at the end of the buffer, in a single read.
+ * @param buffer A pointer to the buffer.
+ * @param file The file to read, from its current position.
+ * @return 1 if the file was read, 0 otherwise.
+ */
+int buffer_write_file(struct buffer *buffer, FILE *file);
+
+/**
+ * @brief Write bytes at the end of the buffer.
+ * @param buffer A pointer to the buffer.
+ * @param bytes The bytes to write.
+ * @param size The number of bytes.
+ */
+void buffer_write_bytes(struct buffer *buffer, const void *bytes, size_t size);
+
+/**
+ * @brief Overwrite bytes already written to the buffer.
+ * @param buffer A pointer to the buffer.
+ * @param position The index of the first byte to overwrite.
+ * @param bytes The bytes to write.
+ * @param size The number of bytes to write.
+ */
+void buffer_set_bytes(struct buffer *buffer, size_t position, const void *bytes, size_t size);
+
+/**
+ * @brief Xor bytes into bytes already written to the buffer.
+ * @param buffer A pointer to the buffer.
+ * @param position The index of the first byte to change.
+ * @param bytes The bytes to xor with.
+ * @param size The number of bytes to change.
+ */
+void buffer_xor_bytes(struct buffer *buffer, size_t position, const void *bytes, size_t size);
+
+/**
+ * @brief Change the number of bytes written to the buffer, the bytes added being zeros.
+ * @param buffer A pointer to the buffer.
+ * @param size The number of bytes of the buffer.
+ */
+void buffer_resize(struct buffer *buffer, size_t size);
+
+/**
+ * @brief Remove the first bytes of the buffer, the other ones moving to its start. The buffer is read again from its start.
+ * @param buffer A pointer to the buffer.
+ * @param size The number of bytes to remove.
+ */
+void buffer_shift(struct buffer *buffer, size_t size);
+
+/**
+ * @brief Write an unsigned value at the end of the buffer, in one byte below 128.
+ * @param buffer A pointer to the buffer.
+ * @param value The value to write.
+ */
+void buffer_write_varint(struct buffer *buffer, Uint32 value);
+
+/**
+ * @brief Write a signed value at the end of the buffer, in one byte from -64 to 63.
+ * @param buffer A pointer to the buffer.
+ * @param value The value to write.
+ */
+void buffer_write_int(struct buffer *buffer, int value);
+
+/**
+ * @brief Read bytes from the buffer, after the values already read.
+ * Reading past the end of the buffer raises an error.
+ * @param buffer A pointer to the buffer.
+ * @param bytes The bytes read.
+ * @param size The number of bytes.
+ */
+void buffer_read_bytes(struct buffer *buffer, void *bytes, size_t size);
+
+/**
+ * @brief Read an unsigned value from the buffer, after the values already read.
+ * Reading past the end of the buffer raises an error.
+ * @param buffer A pointer to the buffer.
+ * @return The value read.
+ */
+Uint32 buffer_read_varint(struct buffer *buffer);
+
+/**
+ * @brief Read a signed value from the buffer, after the values already read.
+ * Reading past the end of the buffer raises an error.
+ * @param buffer A pointer to the buffer.
+ * @return The value read.
+ */
+int buffer_read_int(struct buffer *buffer);
+
+#endif /* BUFFER_H */
@@ -0,0 +1,98 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+/**
+ * @brief Create a camera showing at most width x height cells of a map.
+ * @param width The maximum number of visible columns.
+ * @param height The maximum number of visible rows.
+ * @return A pointer to the newly created camera.
+ */
+struct camera *camera_new(int width, int height);
+
+/**
+ * @brief Free the memory occupied by the camera.
+ * @param camera A pointer to the camera to be freed.
+ */
+void camera_free(struct camera *camera);
+
+/**
+ * @brief Center the camera on a position, without showing anything outside the map.
+ * A position between two cells scrolls the camera between them.
+ * @param camera A pointer to the camera.
+ * @param map_width The width of the map.
+ * @param map_height The height of the map.
+ * @param x The x-coordinate of the position to follow, in cells.
+ * @param y The y-coordinate of the position to follow, in cells.
+ */
+void camera_follow(struct camera *camera, int map_width, int map_height, double x, double y);
+
+/**
+ * @brief Get the x-coordinate of the first visible column, which may be partly scrolled out of the view.
+ * @param camera A pointer to the camera.
+ * @return The x-coordinate of the first visible column.
+ */
+int camera_get_x(struct camera *camera);
+
+/**
+ * @brief Get the y-coordinate of the first visible row, which may be partly scrolled out of the view.
+ * @param camera A pointer to the camera.
+ * @return The y-coordinate of the first visible row.
+ */
+int camera_get_y(struct camera *camera);
+
+/**
+ * @brief Get the part of the first visible column scrolled out of the view.
+ * While it isn't 0, the column after the last one is partly visible too.
+ * @param camera A pointer to the camera.
+ * @return The width scrolled out of the view, in logical coordinates.
+ */
+int camera_get_scroll_x(struct camera *camera);
+
+/**
+ * @brief Get the part of the first visible row scrolled out of the view.
+ * While it isn't 0, the row after the last one is partly visible too.
+ * @param camera A pointer to the camera.
+ * @return The height scrolled out of the view, in logical coordinates.
+ */
+int camera_get_scroll_y(struct camera *camera);
+
+/**
+ * @brief Get the number of visible columns.
+ * @param camera A pointer to the camera.
+ * @return The number of visible columns.
+ */
+int camera_get_width(struct camera *camera);
+
+/**
+ * @brief Get the number of visible rows.
+ * @param camera A pointer to the camera.
+ * @return The number of visible rows.
+ */
+int camera_get_height(struct camera *camera);
+
+/**
+ * @brief Check if a cell is visible, even partly.
+ * @param camera A pointer to the camera.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return 1 if the cell is visible, 0 otherwise.
+ */
+int camera_is_visible(struct camera *camera, int x, int y);
+
+/**
+ * @brief Get the x-coordinate in the window of a position on the map, which may lie between two cells.
+ * @param camera A pointer to the camera.
+ * @param x The x-coordinate on the map, in cells.
+ * @return The x-coordinate in the window before the scroll, in logical coordinates.
+ */
+int camera_project_x(struct camera *camera, double x);
+
+/**
+ * @brief Get the y-coordinate in the window of a position on the map, which may lie between two cells.
+ * @param camera A pointer to the camera.
+ * @param y The y-coordinate on the map, in cells.
+ * @return The y-coordinate in the window before the scroll, in logical coordinates.
+ */
+int camera_project_y(struct camera *camera, double y);
+
+#endif /* CAMERA_H */
@@ -0,0 +1,58 @@
+#ifndef COMPOSITOR_H
+#define COMPOSITOR_H
+
+#include "render.h"
+#include "sprites.h"
+#include <SDL/SDL.h>
+
+/**
+ * @brief Maximum number of threads drawing a frame.
+ */
+#define MAX_COMPOSITOR_THREADS 8
+
+/**
+ * @brief Create a compositor drawing frames on several threads.
+ *
+ * The window is split into one horizontal band per thread. Every thread clears its band
+ * and draws the part of each sprite inside it, in the order of the render queue.
+ *
+ * @param num_threads The number of threads, the calling one included, between 1 and MAX_COMPOSITOR_THREADS.
+ * @return A pointer to the newly created compositor.
+ */
+struct compositor *compositor_new(int num_threads);
+
+/**
+ * @brief Stop the threads of the compositor and free it.
+ * @param compositor A pointer to the compositor to be freed.
+ */
+void compositor_free(struct compositor *compositor);
+
+/**
+ * @brief Clear the window and draw the render queue in it.
+ *
+ * The frame is the same whatever the number of threads. When a sprite isn't supported by
+ * the blit functions, the whole frame is drawn on the calling thread with SDL_BlitSurface.
+ *
+ * @param compositor A pointer to the compositor.
+ * @param queue The render queue of the frame, sorted by this function.
+ * @param window The window to draw in.
+ */
+void compositor_draw(struct compositor *compositor, struct render_queue *queue, SDL_Surface *window);
+
+/**
+ * @brief Get the number of threads drawing a frame.
+ * @param compositor A pointer to the compositor.
+ * @return The number of threads, the calling one included.
+ */
+int compositor_get_num_threads(struct compositor *compositor);
+
+/**
+ * @brief Compare the frame rate of the compositor from 1 to MAX_COMPOSITOR_THREADS threads.
+ * Every frame is also checked to be the same as the one drawn by a single thread.
+ * @param sprites The loaded sprites.
+ * @param window The window to draw in.
+ * @param num_frames Number of frames drawn for each number of threads.
+ */
+void compositor_benchmark(struct sprites *sprites, SDL_Surface *window, int num_frames);
+
+#endif /* COMPOSITOR_H */
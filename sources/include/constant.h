@@ -7,10 +7,36 @@
 #define WINDOW_NAME "Bombeirb"
 
 /**
- * @brief Size (number of pixels) of a cell on the map.
+ * @brief Size (number of pixels) of a cell on the map, in logical coordinates.
+ * The sprites are drawn at the tile size chosen at run time, coordinates are scaled to it.
  */
 #define SIZE_BLOC 60
 
+/**
+ * @brief Minimum size (number of pixels) of a cell in the window.
+ */
+#define MIN_TILE_SIZE 20
+
+/**
+ * @brief Maximum size (number of pixels) of a cell in the window.
+ */
+#define MAX_TILE_SIZE 240
+
+/**
+ * @brief Change of the tile size (number of pixels) on each zoom.
+ */
+#define TILE_SIZE_STEP 10
+
+/**
+ * @brief Maximum number of map columns visible in the window.
+ */
+#define VIEWPORT_WIDTH 12
+
+/**
+ * @brief Maximum number of map rows visible in the window.
+ */
+#define VIEWPORT_HEIGHT 12
+
 /**
  * @brief Size (number of pixels) of the banner line.
  */
@@ -22,10 +48,75 @@
 #define BANNER_HEIGHT 60
 
 /**
- * @brief Default frames per second for the game.
+ * @brief Default number of game ticks per second, the rate of the game logic.
  */
 #define DEFAULT_GAME_FPS 30
 
+/**
+ * @brief Default frames drawn per second, independently of the game ticks.
+ */
+#define DEFAULT_RENDER_FPS 120
+
+/**
+ * @brief Frames drawn per second in a terminal, kept low to save the bandwidth of remote terminals.
+ */
+#define DEFAULT_TERMINAL_FPS 10
+
+/**
+ * @brief Maximum number of game ticks run before drawing a frame, when the game falls behind.
+ */
+#define MAX_TICKS_PER_FRAME 5
+
+/**
+ * @brief Maximum number of backends displaying the same game.
+ */
+#define MAX_BACKENDS 4
+
+/**
+ * @brief Width (number of microseconds) of a step of the latency histograms.
+ */
+#define LATENCY_BUCKET 100
+
+/**
+ * @brief Number of steps of the latency histograms, the last one counting all the longer latencies.
+ */
+#define LATENCY_NUM_BUCKETS 1000
+
+/**
+ * @brief Budget (number of milliseconds) of the 99th percentile of the latency from an input to the frame showing it.
+ */
+#define INPUT_LATENCY_BUDGET 20
+
+/**
+ * @brief Number of game ticks between two keyframes of a replay, the most ticks played again when seeking.
+ */
+#define REPLAY_KEYFRAME_INTERVAL (10 * DEFAULT_GAME_FPS)
+
+/**
+ * @brief Number of game ticks between two autosaves.
+ */
+#define AUTOSAVE_INTERVAL (30 * DEFAULT_GAME_FPS)
+
+/**
+ * @brief Number of autosaves appending the changes of the game to its last whole save, before it is written whole again.
+ */
+#define AUTOSAVE_MAX_CHANGES 10
+
+/**
+ * @brief Number of game ticks played between the checkpoints and the rollbacks of the benchmark.
+ */
+#define CHECKPOINT_BENCH_TICKS (3 * DEFAULT_GAME_FPS)
+
+/**
+ * @brief Number of game ticks the game can be rewound by.
+ */
+#define REWIND_TICKS (30 * DEFAULT_GAME_FPS)
+
+/**
+ * @brief Number of game ticks stepped through at once when rewinding the game or stepping it forward.
+ */
+#define REWIND_STEP_TICKS DEFAULT_GAME_FPS
+
 /**
  * @brief Maximum number of bombs per map allowed.
  */
@@ -56,6 +147,11 @@
  */
 #define DURATION_MONSTER_MOVE 1000
 
+/**
+ * @brief Duration (in milliseconds) the player is drawn moving, a key held down moves it on each game tick.
+ */
+#define DURATION_PLAYER_MOVE (1000 / DEFAULT_GAME_FPS)
+
 /**
  * @brief Duration (in milliseconds) of player's invincibility.
  */
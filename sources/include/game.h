@@ -1,13 +1,18 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "backend.h"
+#include "latency.h"
+#include "buffer.h"
 #include <stdio.h>
 
 /**
  * @brief Create a new game.
+ * @param backend The backend displaying the game and giving its commands.
+ * @param argument The argument of the backend, NULL if none.
  * @return A pointer to the newly created game.
  */
-struct game *game_new(void);
+struct game *game_new(const struct backend *backend, const char *argument);
 
 /**
  * @brief Free the memory occupied by the game.
@@ -16,18 +21,127 @@ struct game *game_new(void);
 void game_free(struct game *game);
 
 /**
- * @brief Write the game to a file.
+ * @brief Write the save file of the game to a buffer: a magic, the version of the format, then a record with
+ * the sections of game_serialize. A record is its size, its sections and their CRC-32.
+ * The changes of the game are followed from this save on.
+ * @param game A pointer to the game.
+ * @param buffer The buffer to write the save to.
+ */
+void game_save(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Write a record of the changes of the game since the previous save, to append to the save file.
+ * It holds the game, the player and the changes of the levels played since then.
+ * @param game A pointer to the game.
+ * @param buffer The buffer to write the record to.
+ */
+void game_save_changes(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Write the save of game_save to a file, in a single write.
  * @param game The game to write.
  * @param file The file to write the game to.
  */
 void game_write(struct game *game, FILE *file);
 
 /**
- * @brief Read the game from a file.
+ * @brief Read the game from a save file, in a single read: the whole save then the changes appended to it.
+ * Exits on a save of another version or a whole save whose checksum doesn't match. A damaged record of
+ * changes and the ones after it are left aside, like an autosave cut by a crash.
  * @param file The file to read the game from.
+ * @param backend The backend displaying the game and giving its commands.
+ * @param argument The argument of the backend, NULL if none.
  * @return A pointer to the game read.
  */
-struct game *game_read(FILE *file);
+struct game *game_read(FILE *file, const struct backend *backend, const char *argument);
+
+/**
+ * @brief Add a backend to the game, displaying it along with the other ones.
+ * The commands of every backend are applied, in the order the backends were added.
+ * @param game A pointer to the game.
+ * @param backend The backend to add.
+ * @param argument The argument of the backend, NULL if none.
+ */
+void game_add_backend(struct game *game, const struct backend *backend, const char *argument);
+
+/**
+ * @brief Write the state of the game to a buffer: its tick, its player, its maps and its pseudo-random numbers.
+ * Each part is a section, a tag followed by the length of its payload, one section per level.
+ * @param game A pointer to the game.
+ * @param buffer The buffer to write the state to.
+ */
+void game_serialize(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Restore a state written by game_serialize, replacing the player and the maps of the game.
+ * The backends and the replay of the game are kept.
+ * @param game A pointer to the game, with the same levels as the one serialized.
+ * @param buffer The buffer to read the state from.
+ */
+void game_restore(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Copy the state of the game to a checkpoint in memory: its tick, its pseudo-random numbers, its player and
+ * its current map, with their bombs and monsters. The copy is done as the state is in memory, without any
+ * allocation once the buffer is large enough.
+ * @param game A pointer to the game.
+ * @param buffer The buffer to copy the state to, cleared before if it held another checkpoint.
+ */
+void game_checkpoint(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Restore a checkpoint of the game in place, as many times as needed. The backends, the replay and the
+ * saves of the game are left as they are.
+ * Only the current level is restored: a checkpoint taken before the game played another level is refused.
+ * @param game A pointer to the game the checkpoint was taken from.
+ * @param buffer The buffer holding the checkpoint.
+ * @return 1 if the checkpoint was restored, 0 if the game played another level since.
+ */
+int game_rollback(struct game *game, struct buffer *buffer);
+
+/**
+ * @brief Record the inputs of a new game to a replay file, until the game is freed.
+ * @param game A pointer to the game, before its first tick.
+ * @param filename The path to the replay file.
+ */
+void game_record(struct game *game, const char *filename);
+
+/**
+ * @brief Play a replay file back on a new game instead of the inputs of the backends, until the end of the replay.
+ * @param game A pointer to the game, before its first tick.
+ * @param filename The path to the replay file.
+ */
+void game_replay(struct game *game, const char *filename);
+
+/**
+ * @brief Save the game every AUTOSAVE_INTERVAL ticks, until the game is freed. The state is captured by the
+ * game tick, then written to the file by a thread of its own. A game freed without being saved on purpose
+ * removes its autosave.
+ * @param game A pointer to the game, neither recording nor playing a replay.
+ * @param filename The path to the save file.
+ */
+void game_autosave(struct game *game, const char *filename);
+
+/**
+ * @brief Keep the changes of the last REWIND_TICKS ticks of the current level, to step the paused game backward
+ * and forward through them. Each tick adds the difference between its checkpoint and the previous one.
+ * @param game A pointer to the game, neither recording nor playing a replay.
+ */
+void game_enable_rewind(struct game *game);
+
+/**
+ * @brief Print the latencies from the inputs to the game ticks and to the frames on stderr, once the game is freed.
+ * @param game A pointer to the game.
+ */
+void game_report_latency(struct game *game);
+
+/**
+ * @brief Go to a game tick of the replay played back, from the latest keyframe before it.
+ * @param game A pointer to the game playing a replay back, whose ticks aren't run on another thread.
+ * @param tick The game tick to go to.
+ * @return 1 if the game ended before the tick, 0 otherwise.
+ */
+int game_seek(struct game *game, Uint32 tick);
 
 /**
  * @brief Get the player of the game.
@@ -51,16 +165,71 @@ struct map *game_get_current_map(struct game *game);
 void game_set_current_level(struct game *game, int level);
 
 /**
- * @brief Display the game on the screen.
+ * @brief Get the current level of the game.
+ * @param game A pointer to the game.
+ * @return The current level, starting from 0.
+ */
+int game_get_current_level(struct game *game);
+
+/**
+ * @brief Get the number of inputs applied since the start of the game, only called from the thread running the game.
+ * @param game A pointer to the game.
+ * @return The number of inputs applied, wrapping around.
+ */
+Uint32 game_get_num_applied_inputs(struct game *game);
+
+/**
+ * @brief Get the latencies from the inputs read by the backends to the game ticks applying them.
+ * @param game A pointer to the game.
+ * @return The histogram of the latencies, only read once the game ticks are over.
+ */
+const struct latency_histogram *game_get_apply_latency(struct game *game);
+
+/**
+ * @brief Get the latencies from the inputs read by the backends to the first frames showing them.
+ * @param game A pointer to the game.
+ * @return The histogram of the latencies, only read from the thread displaying the game.
+ */
+const struct latency_histogram *game_get_present_latency(struct game *game);
+
+/**
+ * @brief Display a snapshot of the game through its backends.
+ * The player and the monsters are drawn between their positions at the start and at the end of the game tick.
+ * The inputs applied up to the snapshot are counted as presented the first time it is displayed.
+ * @param game A pointer to the game.
+ * @param snapshot The snapshot to display.
+ * @param alpha The elapsed fraction of the game tick following the snapshot, from 0 to 1.
+ */
+void game_display(struct game *game, const struct snapshot *snapshot, double alpha);
+
+/**
+ * @brief Read the input of the backends that must be read from the main thread, for the next game tick.
  * @param game A pointer to the game.
  */
-void game_display(struct game *game);
+void game_pump(struct game *game);
 
 /**
- * @brief Update the game state.
+ * @brief Update the game state, applying the inputs of the backends first.
  * @param game A pointer to the game.
  * @return 1 if game is over, 0 otherwise.
  */
 int game_update(struct game *game);
 
+/**
+ * @brief Take and restore checkpoints of the game, printing their size and the time each one takes.
+ * The game is played for CHECKPOINT_BENCH_TICKS ticks between the checkpoints and the rollbacks, recording
+ * their history, which is then stepped through backward and forward.
+ * @param game A pointer to the game.
+ * @param num_checkpoints The number of checkpoints taken and restored.
+ */
+void game_bench_checkpoints(struct game *game, int num_checkpoints);
+
+/**
+ * @brief Go through the levels of the game one after the other, displaying each of them once.
+ * The latency of the level transitions and the resident memory are printed every 100 transitions.
+ * @param game A pointer to the game.
+ * @param num_transitions The number of level transitions.
+ */
+void game_soak_levels(struct game *game, int num_transitions);
+
 #endif /* GAME_H */
@@ -0,0 +1,54 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "buffer.h"
+
+/**
+ * @brief Create a history of states, kept as the differences between each state and the previous one.
+ * The history steps backward and forward through the states, the oldest ones are forgotten past its length.
+ * @param num_steps The number of steps the history keeps at least.
+ * @return A pointer to the newly created history.
+ */
+struct history *history_new(int num_steps);
+
+/**
+ * @brief Free the memory occupied by a history.
+ * @param history A pointer to the history to be freed.
+ */
+void history_free(struct history *history);
+
+/**
+ * @brief Forget every state of the history.
+ * @param history A pointer to the history.
+ */
+void history_clear(struct history *history);
+
+/**
+ * @brief Add a state after the current one. The states the history stepped back from are forgotten.
+ * @param history A pointer to the history.
+ * @param state The new state, copied.
+ */
+void history_record(struct history *history, const struct buffer *state);
+
+/**
+ * @brief Step back to the previous state.
+ * @param history A pointer to the history.
+ * @return The previous state, valid until the next call, or NULL if the history holds no older state.
+ */
+struct buffer *history_back(struct history *history);
+
+/**
+ * @brief Step forward to the next state, after stepping back.
+ * @param history A pointer to the history.
+ * @return The next state, valid until the next call, or NULL if the current state is the latest one.
+ */
+struct buffer *history_forward(struct history *history);
+
+/**
+ * @brief Get the number of bytes taken by the differences between the states.
+ * @param history A pointer to the history.
+ * @return The number of bytes of the differences.
+ */
+size_t history_get_size(struct history *history);
+
+#endif /* HISTORY_H */
@@ -0,0 +1,43 @@
+#ifndef INPUT_RING_H
+#define INPUT_RING_H
+
+#include "backend.h"
+
+/**
+ * @brief Structure representing a command given to the game, with the time it was read.
+ */
+struct input_event {
+    enum action action; /**< The command */
+    Uint64 time; /**< Time the command was read, in microseconds of get_monotonic_time */
+};
+
+/**
+ * @brief Create a ring of input events, passing the events from one thread to another without any lock.
+ * A single thread pushes the events and a single thread pops them.
+ * @return A pointer to the newly created ring.
+ */
+struct input_ring *input_ring_new(void);
+
+/**
+ * @brief Free the memory occupied by the ring.
+ * @param ring A pointer to the ring to be freed.
+ */
+void input_ring_free(struct input_ring *ring);
+
+/**
+ * @brief Add an event at the end of the ring, only called from the thread pushing the events.
+ * @param ring A pointer to the ring.
+ * @param event The event to add.
+ * @return 1 if the event was added, 0 if the ring is full and the event was dropped.
+ */
+int input_ring_push(struct input_ring *ring, const struct input_event *event);
+
+/**
+ * @brief Remove the event at the start of the ring, only called from the thread popping the events.
+ * @param ring A pointer to the ring.
+ * @param event The event removed, left untouched if the ring is empty.
+ * @return 1 if an event was removed, 0 if the ring is empty.
+ */
+int input_ring_pop(struct input_ring *ring, struct input_event *event);
+
+#endif /* INPUT_RING_H */
@@ -0,0 +1,55 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <SDL/SDL.h>
+
+/**
+ * @brief Create an empty histogram of latencies, counting them by steps of LATENCY_BUCKET microseconds.
+ * @return A pointer to the newly created histogram.
+ */
+struct latency_histogram *latency_histogram_new(void);
+
+/**
+ * @brief Free the memory occupied by the histogram.
+ * @param histogram A pointer to the histogram to be freed.
+ */
+void latency_histogram_free(struct latency_histogram *histogram);
+
+/**
+ * @brief Count a latency in the histogram.
+ * @param histogram A pointer to the histogram.
+ * @param latency The latency in microseconds.
+ */
+void latency_histogram_add(struct latency_histogram *histogram, Uint64 latency);
+
+/**
+ * @brief Get the number of latencies counted in the histogram.
+ * @param histogram A pointer to the histogram.
+ * @return The number of latencies.
+ */
+int latency_histogram_get_count(const struct latency_histogram *histogram);
+
+/**
+ * @brief Get a percentile of the latencies counted in the histogram.
+ * @param histogram A pointer to the histogram.
+ * @param percentile The percentile, from 0 to 100.
+ * @return The latency in microseconds below which lie the given percentage of the latencies, rounded up to the
+ * end of its bucket but never above the maximum. 0 if the histogram is empty.
+ */
+Uint64 latency_histogram_get_percentile(const struct latency_histogram *histogram, double percentile);
+
+/**
+ * @brief Get the highest latency counted in the histogram.
+ * @param histogram A pointer to the histogram.
+ * @return The maximum latency in microseconds, 0 if the histogram is empty.
+ */
+Uint64 latency_histogram_get_max(const struct latency_histogram *histogram);
+
+/**
+ * @brief Print the count, the median, the 99th percentile and the maximum of the histogram on one line of stderr.
+ * @param histogram A pointer to the histogram.
+ * @param name The name of the latencies, starting the line.
+ */
+void latency_histogram_print(const struct latency_histogram *histogram, const char *name);
+
+#endif /* LATENCY_H */
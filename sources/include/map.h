@@ -2,7 +2,6 @@
 #define MAP_H
 
 #include "player.h"
-#include "window.h"
 #include "bomb_node.h"
 #include "monster_node.h"
 
@@ -29,18 +28,62 @@ struct map *map_new(char *filename);
 void map_free(struct map *map);
 
 /**
- * @brief Write a map to a file.
+ * @brief Write a map to a buffer, in a compact form which doesn't depend on the platform.
  * @param map The map to write.
- * @param file The file to write the map to.
+ * @param buffer The buffer to write the map to.
  */
-void map_write(struct map *map, FILE *file);
+void map_serialize(struct map *map, struct buffer *buffer);
 
 /**
- * @brief Read a map from a file.
- * @param file The file to read the map from.
+ * @brief Read a map written by map_serialize.
+ * @param buffer The buffer to read the map from.
  * @return A pointer to the map read.
  */
-struct map *map_read(FILE *file);
+struct map *map_deserialize(struct buffer *buffer);
+
+/**
+ * @brief Write the changes of a map since map_clear_changes to a buffer: the rows of the grid changed, from
+ * the first one to the last one, then all the bombs and the monsters if any of them changed.
+ * @param map The map to write the changes of.
+ * @param buffer The buffer to write the changes to.
+ */
+void map_serialize_changes(struct map *map, struct buffer *buffer);
+
+/**
+ * @brief Apply changes written by map_serialize_changes to the map they were written from, as it was before them.
+ * @param map The map to apply the changes to.
+ * @param buffer The buffer to read the changes from.
+ */
+void map_deserialize_changes(struct map *map, struct buffer *buffer);
+
+/**
+ * @brief Forget the changes of the grid, the bombs and the monsters of a map, once they are saved.
+ * @param map A pointer to the map.
+ */
+void map_clear_changes(struct map *map);
+
+/**
+ * @brief Tell whether the grid, the bombs or the monsters of a map changed since map_clear_changes.
+ * @param map A pointer to the map.
+ * @return 1 if the map changed, 0 otherwise.
+ */
+int map_has_changes(struct map *map);
+
+/**
+ * @brief Copy a map to a checkpoint, as it is in memory: its grid, then its bombs and its monsters.
+ * Only read back by this process.
+ * @param map The map to copy.
+ * @param buffer The buffer to copy the map to.
+ */
+void map_checkpoint(struct map *map, struct buffer *buffer);
+
+/**
+ * @brief Restore a map copied by map_checkpoint, in place. The nodes of the map are reused, new ones are only
+ * allocated when the map had more bombs or monsters at the time of the checkpoint.
+ * @param map The map to restore, the one copied.
+ * @param buffer The buffer to read the map from.
+ */
+void map_rollback(struct map *map, struct buffer *buffer);
 
 /**
  * @brief Get the width of the map.
@@ -98,6 +141,23 @@ void map_add_monster_node(struct map *map, struct monster_node *to_add);
  */
 void map_remove_monster_node(struct map *map, struct monster_node *to_remove);
 
+/**
+ * @brief Get the monster standing on the cell at the specified coordinates (x, y).
+ * @param map A pointer to the map.
+ * @param x The x-coordinate.
+ * @param y The y-coordinate.
+ * @return A pointer to the monster, or NULL if the cell is free of monsters.
+ */
+struct monster_node *map_get_monster(struct map *map, int x, int y);
+
+/**
+ * @brief Move a monster of the map by one cell, keeping the monster lookup by cell up to date.
+ * @param map A pointer to the map.
+ * @param monster A pointer to the monster.
+ * @param direction The direction where the monster is moving.
+ */
+void map_move_monster(struct map *map, struct monster_node *monster, enum direction direction);
+
 /**
  * @brief Get the head of the bombs' linked list on the map.
  * @param map A pointer to the map.
@@ -147,10 +207,35 @@ unsigned char map_get_cell_value(struct map *map, int x, int y);
 void map_set_cell_value(struct map *map, int x, int y, unsigned char value);
 
 /**
- * @brief Display the map on the screen.
+ * @brief Work out the bomb sprite of every cell from the bombs of the map, the fuses and the explosions.
+ * The game logic never reads them, they are only built when a snapshot is taken for a backend that draws.
+ * @param map A pointer to the map.
+ */
+void map_build_bomb_sprites(struct map *map);
+
+/**
+ * @brief Check if a cell is in the blast of an exploding bomb. The blasts aren't written to the grid.
+ * @param map A pointer to the map.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return 1 if the cell is in a blast, 0 otherwise.
+ */
+int map_is_exploding(struct map *map, int x, int y);
+
+/**
+ * @brief Get the bomb sprite of a cell, as last built by map_build_bomb_sprites.
  * @param map A pointer to the map.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return The state of the bomb drawn on the cell, DONE if there is none.
  */
-void map_display(struct map *map, SDL_Surface *window, struct sprites *sprites);
+enum bomb_state map_get_bomb_sprite(struct map *map, int x, int y);
+
+/**
+ * @brief Remember the position of every monster as the one before its last move, so that none of them slides.
+ * @param map A pointer to the map.
+ */
+void map_save_positions(struct map *map);
 
 /**
 @brief Set a bomb on the map at the player's current position.
@@ -183,8 +268,6 @@ int map_move_player(struct map *map, struct player *player, enum direction direc
 */
 int map_will_monster_meet_player(struct monster_node *monster, struct player *player, enum direction monster_direction);
 
-int map_will_monster_meet_other_monsters(struct monster_node *current_monster, struct monster_node *monster_head, enum direction current_monster_direction);
-
 /**
 @brief Checks if a monster_node can move.
 @param A pointer to the player.
@@ -196,10 +279,11 @@ int map_can_monster_move(struct map *map, struct player *player, struct monster_
 
 /**
 @brief Meeting between a monster_node and the player.
+@param map A pointer to the map.
 @param monster A pointer to the monster_node.
 @param player A pointer to the player.
 @param monster_direction The direction of the monster_node.
 */
-void map_monster_meeting_player(struct monster_node *monster, struct player *player, enum direction monster_direction);
+void map_monster_meeting_player(struct map *map, struct monster_node *monster, struct player *player, enum direction monster_direction);
 
 #endif /* MAP_H */
@@ -18,4 +18,22 @@ void error(const char *s, ...);
  */
 SDL_Surface *image_load(const char *filename);
 
+/**
+ * @brief Get the number of processors available.
+ * @return The number of online processors, at least 1.
+ */
+int get_num_processors(void);
+
+/**
+ * @brief Get the resident memory of the process.
+ * @return The resident set size in bytes, or 0 if it can't be measured.
+ */
+size_t get_resident_memory(void);
+
+/**
+ * @brief Get the time of a monotonic clock, finer than SDL_GetTicks and never going back.
+ * @return The time in microseconds, from an unspecified start.
+ */
+Uint64 get_monotonic_time(void);
+
 #endif /* MISC_H */
@@ -2,7 +2,9 @@
 #define MONSTER_NODE_H
 
 #include "timer.h"
-#include "sprites.h"
+#include "direction.h"
+#include "buffer.h"
+#include <stdio.h>
 
 /**
  * @brief Initialize a monster node with the specified coordinates and timer duration.
@@ -20,18 +22,32 @@ struct monster_node *monster_node_new(int x, int y);
 void monster_node_free(struct monster_node *monster_node);
 
 /**
- * @brief Write a monster node to a file.
+ * @brief Write a monster node to a buffer, in a compact form which doesn't depend on the platform.
  * @param monster_node The monster node to write.
- * @param file The file to write the monster node to.
+ * @param buffer The buffer to write the monster node to.
  */
-void monster_node_write(struct monster_node *monster_node, FILE *file);
+void monster_node_serialize(struct monster_node *monster_node, struct buffer *buffer);
 
 /**
- * @brief Read a monster node from a file.
- * @param file The file to read the monster node from.
- * @return A pointer to the monster read.
+ * @brief Read a monster node written by monster_node_serialize.
+ * @param buffer The buffer to read the monster node from.
+ * @return A pointer to the monster node read.
  */
-struct monster_node *monster_node_read(FILE *file);
+struct monster_node *monster_node_deserialize(struct buffer *buffer);
+
+/**
+ * @brief Copy a monster node to a checkpoint, as it is in memory. Only read back by this process.
+ * @param monster_node The monster node to copy.
+ * @param buffer The buffer to copy the monster node to.
+ */
+void monster_node_checkpoint(struct monster_node *monster_node, struct buffer *buffer);
+
+/**
+ * @brief Restore a monster node copied by monster_node_checkpoint, in place: it keeps its timer and its place in the list.
+ * @param monster_node The monster node to restore.
+ * @param buffer The buffer to read the monster node from.
+ */
+void monster_node_rollback(struct monster_node *monster_node, struct buffer *buffer);
 
 /**
  * @brief Set the x-coordinate of the monster node.
@@ -90,7 +106,7 @@ enum direction monster_node_get_direction(struct monster_node *monster_node);
 void monster_node_set_direction(struct monster_node *monster_node, enum direction direction);
 
 /**
- * @brief Get the timer of the monster node.
+ * @brief Get the timer of the monster node, restarted for DURATION_MONSTER_MOVE by each move.
  * @param monster_node A pointer to the monster node.
  * @return A pointer to the timer of the monster node.
  */
@@ -104,10 +120,25 @@ struct timer *monster_node_get_timer(struct monster_node *monster_node);
 void monster_node_set_timer(struct monster_node *monster_node, struct timer *timer);
 
 /**
- * @brief Display the sprite of the monster node.
+ * @brief Remember the position of the monster node as the one before its last move, the frames are interpolated from it.
+ * Called by monster_node_move, and when the monster node stays where it is for another move duration.
+ * @param monster_node A pointer to the monster node.
+ */
+void monster_node_save_position(struct monster_node *monster_node);
+
+/**
+ * @brief Get the x-coordinate of the monster node before its last move.
+ * @param monster_node A pointer to the monster node.
+ * @return The x-coordinate saved by monster_node_save_position.
+ */
+int monster_node_get_previous_x(struct monster_node *monster_node);
+
+/**
+ * @brief Get the y-coordinate of the monster node before its last move.
  * @param monster_node A pointer to the monster node.
+ * @return The y-coordinate saved by monster_node_save_position.
  */
-void monster_node_display(struct monster_node *monster_node, SDL_Surface *window, struct sprites *sprites);
+int monster_node_get_previous_y(struct monster_node *monster_node);
 
 /**
  * @brief Move the monster node.
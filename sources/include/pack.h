@@ -0,0 +1,51 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <SDL/SDL.h>
+
+/**
+ * @brief Open a sprite pack: an atlas already in display format and the area of each sprite in it.
+ *
+ * The pack file is mapped in memory and the atlas surface is created on top of the mapping,
+ * so no image is decoded. The pack is rejected when it is missing, when it was baked for other
+ * image files or another display format, or when one of its image files changed since.
+ *
+ * @param filename The path to the pack file.
+ * @param paths The image file of each sprite, in the order they were baked.
+ * @param num_sprites The number of sprites.
+ * @return A pointer to the opened pack, or NULL if the images must be decoded instead.
+ */
+struct pack *pack_open(const char *filename, const char **paths, int num_sprites);
+
+/**
+ * @brief Close a sprite pack, freeing its atlas and unmapping the file.
+ * @param pack A pointer to the pack to be closed.
+ */
+void pack_close(struct pack *pack);
+
+/**
+ * @brief Get the atlas of a sprite pack.
+ * @param pack A pointer to the pack.
+ * @return The atlas surface, owned by the pack.
+ */
+SDL_Surface *pack_get_atlas(struct pack *pack);
+
+/**
+ * @brief Get the area of a sprite in the atlas of a sprite pack.
+ * @param pack A pointer to the pack.
+ * @param index The index of the sprite.
+ * @return The area of the sprite in the atlas.
+ */
+SDL_Rect pack_get_rect(struct pack *pack, int index);
+
+/**
+ * @brief Bake an atlas and the area of each sprite in it into a pack file.
+ * @param filename The path to the pack file.
+ * @param atlas The atlas, in display format.
+ * @param paths The image file of each sprite.
+ * @param rects The area of each sprite in the atlas.
+ * @param num_sprites The number of sprites.
+ */
+void pack_write(const char *filename, SDL_Surface *atlas, const char **paths, SDL_Rect *rects, int num_sprites);
+
+#endif /* PACK_H */
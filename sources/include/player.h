@@ -1,7 +1,10 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
-#include "sprites.h"
+#include "direction.h"
+#include "cell_types.h"
+#include "buffer.h"
+#include <stdio.h>
 
 /**
  * @brief Creates a new player with a given number of available bombs.
@@ -19,18 +22,32 @@ struct player *player_new(int x, int y, int num_bombs);
 void player_free(struct player *player);
 
 /**
- * @brief Write the player to a file.
+ * @brief Write a player to a buffer, in a compact form which doesn't depend on the platform.
  * @param player The player to write.
- * @param file The file to write the player to.
+ * @param buffer The buffer to write the player to.
  */
-void player_write(struct player *player, FILE *file);
+void player_serialize(struct player *player, struct buffer *buffer);
 
 /**
- * @brief Read the player from a file.
- * @param file The file to read the player from.
+ * @brief Read a player written by player_serialize.
+ * @param buffer The buffer to read the player from.
  * @return A pointer to the player read.
  */
-struct player *player_read(FILE *file);
+struct player *player_deserialize(struct buffer *buffer);
+
+/**
+ * @brief Copy a player to a checkpoint, as it is in memory. Only read back by this process.
+ * @param player The player to copy.
+ * @param buffer The buffer to copy the player to.
+ */
+void player_checkpoint(struct player *player, struct buffer *buffer);
+
+/**
+ * @brief Restore a player copied by player_checkpoint, in place: it keeps its timer.
+ * @param player The player to restore.
+ * @param buffer The buffer to read the player from.
+ */
+void player_rollback(struct player *player, struct buffer *buffer);
 
 /**
  * @brief Get the current x-coordinate of the player's position.
@@ -139,10 +156,25 @@ void player_inc_num_keys(struct player *player);
 void player_dec_num_keys(struct player *player);
 
 /**
- * @brief Display the player on the screen.
+ * @brief Remember the position of the player as the one before its last move, the frames are interpolated from it.
+ * Called by player_move, and when the player is put somewhere without sliding there.
+ * @param player A pointer to the player.
+ */
+void player_save_position(struct player *player);
+
+/**
+ * @brief Get the x position of the player before its last move.
+ * @param player A pointer to the player.
+ * @return The x position saved by player_save_position.
+ */
+int player_get_previous_x(struct player *player);
+
+/**
+ * @brief Get the y position of the player before its last move.
  * @param player A pointer to the player.
+ * @return The y position saved by player_save_position.
  */
-void player_display(struct player *player, SDL_Surface *window, struct sprites *sprites);
+int player_get_previous_y(struct player *player);
 
 /**
  * @brief Get the number of lives the player has.
@@ -170,6 +202,13 @@ void player_dec_num_lives(struct player *player);
  */
 struct timer *player_get_timer_invincibility(struct player *player);
 
+/**
+ * @brief Get the timer of the last move of the player, started by player_move for DURATION_PLAYER_MOVE.
+ * @param player A pointer to the player.
+ * @return A pointer to the timer of the last move of the player.
+ */
+struct timer *player_get_timer_move(struct player *player);
+
 /**
  * @brief Set the timer for invincibility of the player.
  * @param player A pointer to the player.
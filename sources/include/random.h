@@ -2,6 +2,26 @@
 #define RANDOM_H
 
 #include "map.h"
+#include <SDL/SDL.h>
+
+/**
+@brief Seed the pseudo-random numbers of the game, the same seed giving the same numbers on every platform.
+@param seed The seed.
+*/
+void random_set_seed(Uint32 seed);
+
+/**
+@brief Get the state of the pseudo-random numbers, seeding them with it goes on with the same numbers.
+@return The state of the pseudo-random numbers.
+*/
+Uint32 random_get_state(void);
+
+/**
+@brief Get the next pseudo-random number of the game, only called from the thread running the game.
+@param max The upper bound of the number, excluded.
+@return A number between 0 and max - 1.
+*/
+int random_get_int(int max);
 
 void random_move_monster(struct map *map, struct monster_node *monster, struct player *player);
 
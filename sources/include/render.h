@@ -0,0 +1,102 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "sprites.h"
+#include <SDL/SDL.h>
+
+/**
+ * @enum render_layer
+ * @brief Represents the layers of a frame, drawn from the first to the last.
+ */
+enum render_layer {
+    LAYER_BACKGROUND, /**< Scenery of the map */
+    LAYER_CELLS, /**< Boxes, bonuses, keys, doors and bombs */
+    LAYER_ENTITIES, /**< Player and monsters */
+    LAYER_BANNER /**< Banner below the map */
+};
+
+/**
+ * @brief Structure representing a sprite to draw in a frame.
+ */
+struct render_command {
+    struct sprite sprite; /**< Sprite to draw */
+    Sint16 x; /**< x-coordinate of the sprite in the window */
+    Sint16 y; /**< y-coordinate of the sprite in the window */
+    Uint16 layer; /**< Layer of the sprite */
+    Uint32 order; /**< Position of the command in its queue, when it was pushed */
+};
+
+/**
+ * @brief Create an empty render queue.
+ * @return A pointer to the newly created render queue.
+ */
+struct render_queue *render_queue_new(void);
+
+/**
+ * @brief Free the render queue.
+ * @param queue A pointer to the render queue to be freed.
+ */
+void render_queue_free(struct render_queue *queue);
+
+/**
+ * @brief Remove every command of the render queue, to build a new frame.
+ * @param queue A pointer to the render queue.
+ */
+void render_queue_clear(struct render_queue *queue);
+
+/**
+ * @brief Set the tile size the coordinates of the next commands are scaled to.
+ * @param queue A pointer to the render queue.
+ * @param tile_size The size of a cell in pixels, SIZE_BLOC by default.
+ */
+void render_queue_set_tile_size(struct render_queue *queue, int tile_size);
+
+/**
+ * @brief Move the next commands up and left, to scroll the map between two cells.
+ * The scroll is kept until it is set again.
+ * @param queue A pointer to the render queue.
+ * @param x The distance the next commands are moved to the left by, in logical coordinates.
+ * @param y The distance the next commands are moved up by, in logical coordinates.
+ */
+void render_queue_set_scroll(struct render_queue *queue, int x, int y);
+
+/**
+ * @brief Add a sprite to draw in the frame.
+ * Overlapping sprites of the same layer and surface are drawn in the order they were pushed, the last one on top.
+ * Those of the same layer from different surfaces may be drawn in any order, they must not overlap.
+ * @param queue A pointer to the render queue.
+ * @param sprite The sprite to draw, already scaled to the tile size, copied in the queue.
+ * @param x The x-coordinate of the sprite in the window before the scroll, in logical coordinates.
+ * @param y The y-coordinate of the sprite in the window before the scroll, in logical coordinates.
+ * @param layer The layer of the sprite.
+ */
+void render_queue_push(struct render_queue *queue, struct sprite *sprite, int x, int y, enum render_layer layer);
+
+/**
+ * @brief Sort the commands of the render queue by layer, then by source surface.
+ * @param queue A pointer to the render queue.
+ */
+void render_queue_sort(struct render_queue *queue);
+
+/**
+ * @brief Sort the commands of the render queue and draw them in the window.
+ * @param queue A pointer to the render queue.
+ * @param window The window to draw in.
+ */
+void render_queue_execute(struct render_queue *queue, SDL_Surface *window);
+
+/**
+ * @brief Get the number of commands in the render queue.
+ * @param queue A pointer to the render queue.
+ * @return The number of commands.
+ */
+int render_queue_get_num_commands(struct render_queue *queue);
+
+/**
+ * @brief Get the commands of the render queue.
+ * @param queue A pointer to the render queue.
+ * @return The array of commands, valid until the next push.
+ */
+struct render_command *render_queue_get_commands(struct render_queue *queue);
+
+#endif /* RENDER_H */
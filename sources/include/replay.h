@@ -0,0 +1,84 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "backend.h"
+#include "buffer.h"
+
+/**
+ * @brief Start recording a new game to a replay file, seeding the pseudo-random numbers of the game.
+ * The file holds the seed, the hash of the levels at the start, the inputs with the game ticks applying them and
+ * keyframes of the whole state of the game, with an index of the keyframes at its end.
+ * @param filename The path to the replay file.
+ * @param level_hash The hash of the game before its first tick.
+ * @return A pointer to the newly created replay.
+ */
+struct replay *replay_new_recording(const char *filename, Uint32 level_hash);
+
+/**
+ * @brief Start playing a replay file back on a new game, seeding the pseudo-random numbers of the game like
+ * the recording did.
+ * @param filename The path to the replay file.
+ * @param level_hash The hash of the game before its first tick, which must be the one of the recording.
+ * @return A pointer to the newly created replay.
+ */
+struct replay *replay_new_playback(const char *filename, Uint32 level_hash);
+
+/**
+ * @brief Stop the replay and free the memory it occupies.
+ * A recording writes the final state of the game, a playback compares it with the one recorded.
+ * @param replay A pointer to the replay to be freed.
+ * @param tick The last game tick.
+ * @param state_hash The hash of the game after its last tick.
+ */
+void replay_free(struct replay *replay, Uint32 tick, Uint32 state_hash);
+
+/**
+ * @brief Tell whether the replay plays a file back.
+ * @param replay A pointer to the replay.
+ * @return 1 if the replay plays a file back, 0 if it records one.
+ */
+int replay_is_playback(struct replay *replay);
+
+/**
+ * @brief Record an input applied by the game, only called while recording.
+ * @param replay A pointer to the replay.
+ * @param tick The game tick applying the input, never before the previous one recorded.
+ * @param action The input.
+ */
+void replay_record(struct replay *replay, Uint32 tick, enum action action);
+
+/**
+ * @brief Record a keyframe, only called while recording.
+ * @param replay A pointer to the replay.
+ * @param tick The game tick after which the state was written, never before the previous one recorded.
+ * @param state The state of the game, written by game_serialize.
+ */
+void replay_record_keyframe(struct replay *replay, Uint32 tick, struct buffer *state);
+
+/**
+ * @brief Go to the latest keyframe at or before a game tick, only called while playing back.
+ * The inputs following the keyframe are played next. A recording cut short has its keyframes found again.
+ * @param replay A pointer to the replay.
+ * @param tick The game tick to go to.
+ * @param state The buffer receiving the state of the game at the keyframe.
+ * @return The game tick of the keyframe.
+ */
+Uint32 replay_seek(struct replay *replay, Uint32 tick, struct buffer *state);
+
+/**
+ * @brief Get the next input recorded for a game tick, only called while playing back.
+ * @param replay A pointer to the replay.
+ * @param tick The current game tick, never before the previous one played.
+ * @return The next input, ACTION_NONE when there is no more for this tick.
+ */
+enum action replay_play(struct replay *replay, Uint32 tick);
+
+/**
+ * @brief Tell whether a playback is over: the game went past the last tick recorded.
+ * @param replay A pointer to the replay.
+ * @param tick The current game tick.
+ * @return 1 if the playback is over, 0 otherwise.
+ */
+int replay_is_over(struct replay *replay, Uint32 tick);
+
+#endif /* REPLAY_H */
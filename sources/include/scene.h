@@ -0,0 +1,35 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "snapshot.h"
+#include "camera.h"
+#include "render.h"
+#include "sprites.h"
+
+/**
+ * @brief Create a scene, drawing the snapshots of the game with sprites.
+ * @return A pointer to the newly created scene.
+ */
+struct scene *scene_new(void);
+
+/**
+ * @brief Free the memory occupied by the scene.
+ * @param scene A pointer to the scene to be freed.
+ */
+void scene_free(struct scene *scene);
+
+/**
+ * @brief Display the visible part of the map of a snapshot, with its bombs, its monsters and the player.
+ * The scenery of each level is pre-composited into a background, built on the first display of the level.
+ * The player and the monsters slide over the duration of their moves. The commands of the map are scrolled like
+ * the camera, the scroll of the queue is back to 0 for the next ones.
+ * @param scene A pointer to the scene.
+ * @param queue The render queue of the frame.
+ * @param sprites The sprites of the game.
+ * @param camera The camera giving the visible part of the map.
+ * @param snapshot The snapshot to display.
+ * @param alpha The elapsed fraction of the game tick following the snapshot, to interpolate the moves.
+ */
+void scene_display(struct scene *scene, struct render_queue *queue, struct sprites *sprites, struct camera *camera, const struct snapshot *snapshot, double alpha);
+
+#endif /* SCENE_H */
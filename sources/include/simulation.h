@@ -0,0 +1,37 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "game.h"
+#include "snapshot.h"
+
+/**
+ * @brief Start running the game ticks on a thread of their own, at DEFAULT_GAME_FPS.
+ * A snapshot of the game is published after each tick, the display draws the latest one at its own rate.
+ * Until the simulation is freed, the game must only be displayed through its snapshots and pumped.
+ * @param game A pointer to the game.
+ * @return A pointer to the newly created simulation.
+ */
+struct simulation *simulation_new(struct game *game);
+
+/**
+ * @brief Wait for the end of the game and free the memory occupied by the simulation.
+ * @param simulation A pointer to the simulation to be freed.
+ */
+void simulation_free(struct simulation *simulation);
+
+/**
+ * @brief Tell whether the game is over.
+ * @param simulation A pointer to the simulation.
+ * @return 1 if the game is over, 0 otherwise.
+ */
+int simulation_is_over(struct simulation *simulation);
+
+/**
+ * @brief Get the snapshot of the latest game tick, only called from the thread displaying the game.
+ * The snapshot stays valid until the next call.
+ * @param simulation A pointer to the simulation.
+ * @return The latest snapshot.
+ */
+const struct snapshot *simulation_get_snapshot(struct simulation *simulation);
+
+#endif /* SIMULATION_H */
@@ -0,0 +1,144 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "direction.h"
+#include "cell_types.h"
+#include <SDL/SDL.h>
+
+struct game;
+
+/**
+ * @brief Structure representing the position of a player or a monster in a snapshot.
+ */
+struct snapshot_entity {
+    int x; /**< X position at the end of the game tick */
+    int y; /**< Y position at the end of the game tick */
+    int previous_x; /**< X position before the last move */
+    int previous_y; /**< Y position before the last move */
+    enum direction direction; /**< Direction the entity is looking toward */
+    double progress; /**< Fraction of the last move drawn at the end of the game tick, 1 once it is over */
+    double speed; /**< Fraction of the last move drawn during a game tick */
+};
+
+/**
+ * @brief Structure representing everything needed to draw the game at the end of a game tick.
+ * The snapshots are copies: they are drawn while the game goes on with the next ticks.
+ */
+struct snapshot {
+    Uint32 time; /**< Time the snapshot was taken, the frames are interpolated from it */
+    int level; /**< Current level, starting from 0 */
+    int width; /**< Width of the current map */
+    int height; /**< Height of the current map */
+    unsigned char *grid; /**< Cells of the current map */
+    unsigned char *bomb_sprites; /**< Bomb state drawn on each cell plus one, 0 if none */
+    int *monster_cells; /**< Index of the monster standing on each cell plus one, 0 if none */
+    int num_cells; /**< Number of cells grid, bomb_sprites and monster_cells can hold */
+    struct snapshot_entity *monsters; /**< Monsters of the current map */
+    int num_monsters; /**< Number of monsters of the current map */
+    int max_monsters; /**< Number of monsters the monsters array can hold */
+    struct snapshot_entity player; /**< Position of the player */
+    int num_lives; /**< Number of lives of the player */
+    int num_bombs; /**< Number of bombs of the player */
+    int range_bombs; /**< Range of the player's bombs */
+    int num_keys; /**< Number of keys of the player */
+    Uint32 num_inputs; /**< Number of inputs applied by the game up to this tick, wrapping around */
+};
+
+/**
+ * @brief Create an empty snapshot, of a map without any cell.
+ * @return A pointer to the newly created snapshot.
+ */
+struct snapshot *snapshot_new(void);
+
+/**
+ * @brief Free the memory occupied by a snapshot.
+ * @param snapshot A pointer to the snapshot to be freed.
+ */
+void snapshot_free(struct snapshot *snapshot);
+
+/**
+ * @brief Copy the state of the game to a snapshot, growing the snapshot if needed.
+ * @param snapshot A pointer to the snapshot.
+ * @param game A pointer to the game.
+ */
+void snapshot_capture(struct snapshot *snapshot, struct game *game);
+
+/**
+ * @brief Get the value of a cell of a snapshot.
+ * @param snapshot A pointer to the snapshot.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return The value of the cell.
+ */
+unsigned char snapshot_get_cell_value(const struct snapshot *snapshot, int x, int y);
+
+/**
+ * @brief Get the bomb drawn on a cell of a snapshot.
+ * @param snapshot A pointer to the snapshot.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return The state of the bomb drawn on the cell, DONE if there is none.
+ */
+enum bomb_state snapshot_get_bomb_sprite(const struct snapshot *snapshot, int x, int y);
+
+/**
+ * @brief Get the monster standing on a cell of a snapshot.
+ * @param snapshot A pointer to the snapshot.
+ * @param x The x-coordinate of the cell.
+ * @param y The y-coordinate of the cell.
+ * @return The monster standing on the cell at the end of the game tick, NULL if there is none.
+ */
+const struct snapshot_entity *snapshot_get_monster(const struct snapshot *snapshot, int x, int y);
+
+/**
+ * @brief Get the x position an entity of a snapshot is drawn at, sliding from its previous position.
+ * @param entity A pointer to the entity.
+ * @param alpha The elapsed fraction of the game tick following the snapshot.
+ * @return The x position, between two cells while the entity moves.
+ */
+double snapshot_entity_get_x(const struct snapshot_entity *entity, double alpha);
+
+/**
+ * @brief Get the y position an entity of a snapshot is drawn at, sliding from its previous position.
+ * @param entity A pointer to the entity.
+ * @param alpha The elapsed fraction of the game tick following the snapshot.
+ * @return The y position, between two cells while the entity moves.
+ */
+double snapshot_entity_get_y(const struct snapshot_entity *entity, double alpha);
+
+/**
+ * @brief Create a triple buffer of snapshots, passing the snapshots from the game to the display without any lock.
+ * The game writes the back snapshot while the display reads the front one, the third one holds the latest
+ * snapshot published and not read yet.
+ * @return A pointer to the newly created triple buffer.
+ */
+struct snapshot_buffer *snapshot_buffer_new(void);
+
+/**
+ * @brief Free the memory occupied by a triple buffer and its snapshots.
+ * @param buffer A pointer to the triple buffer to be freed.
+ */
+void snapshot_buffer_free(struct snapshot_buffer *buffer);
+
+/**
+ * @brief Get the snapshot to write, only called from the thread of the game.
+ * @param buffer A pointer to the triple buffer.
+ * @return The back snapshot.
+ */
+struct snapshot *snapshot_buffer_get_back(struct snapshot_buffer *buffer);
+
+/**
+ * @brief Publish the back snapshot, which becomes the latest one. Only called from the thread of the game.
+ * @param buffer A pointer to the triple buffer.
+ */
+void snapshot_buffer_publish(struct snapshot_buffer *buffer);
+
+/**
+ * @brief Get the latest snapshot published, only called from the thread of the display.
+ * The snapshot stays valid until the next call.
+ * @param buffer A pointer to the triple buffer.
+ * @return The front snapshot.
+ */
+const struct snapshot *snapshot_buffer_get_latest(struct snapshot_buffer *buffer);
+
+#endif /* SNAPSHOT_H */
@@ -5,6 +5,20 @@
 #include "cell_types.h"
 #include <SDL/SDL.h>
 
+/**
+ * @brief A sprite: an area of the sprite atlas.
+ */
+struct sprite {
+    SDL_Surface *surface; /**< Surface holding the pixels of the sprite */
+    SDL_Rect rect; /**< Area of the sprite inside the surface */
+};
+
+/**
+ * @brief Load every sprite and pack them into a single atlas in display format.
+ * The atlas is mapped from the sprite pack when it is up to date, otherwise the images are decoded.
+ * @note The video mode must be set before calling this function.
+ * @return A pointer to the loaded sprites.
+ */
 struct sprites *sprites_new();
 
 /**
@@ -12,113 +26,170 @@ struct sprites *sprites_new();
  */
 void sprites_free(struct sprites *sprites);
 
+/**
+ * @brief Get the memory used by the pixels of the sprites: the atlas, the atlases scaled from it and the digit strips.
+ * The decoded images aren't counted, they are released once copied to the atlas.
+ * @param sprites The loaded sprites.
+ * @return The resident memory in bytes.
+ */
+size_t sprites_get_resident_memory(struct sprites *sprites);
+
+/**
+ * @brief Draw the sprites at another tile size.
+ *
+ * The sprites are scaled with an area filter into an atlas of their own the first time a tile size
+ * is used. The last scaled atlases are kept, so going back to one of these sizes doesn't scale again.
+ *
+ * @param sprites The loaded sprites.
+ * @param tile_size The size of a cell in pixels, between MIN_TILE_SIZE and MAX_TILE_SIZE.
+ */
+void sprites_set_tile_size(struct sprites *sprites, int tile_size);
+
+/**
+ * @brief Get the tile size the sprites are drawn at.
+ * @param sprites The loaded sprites.
+ * @return The size of a cell in pixels, SIZE_BLOC unless changed.
+ */
+int sprites_get_tile_size(struct sprites *sprites);
+
+/**
+ * @brief Scale a length in logical coordinates, where a cell is SIZE_BLOC pixels wide, to a tile size.
+ * @param length The length in logical coordinates.
+ * @param tile_size The size of a cell in pixels.
+ * @return The length in pixels, rounded to the nearest.
+ */
+int sprites_scale_length(int length, int tile_size);
+
+/**
+ * @brief Bake the atlas into the sprite pack, loaded instead of the images as long as they don't change.
+ * @param sprites The loaded sprites.
+ */
+void sprites_bake_pack(struct sprites *sprites);
+
+/**
+ * @brief Compare the blit throughput of the surfaces returned by image_load with the one of the atlas.
+ * @param sprites The loaded sprites.
+ * @param window The window to blit the sprites in.
+ * @param iterations Number of blits of each sprite.
+ */
+void sprites_benchmark(struct sprites *sprites, SDL_Surface *window, int iterations);
+
 /**
  * @brief Get the sprite for the princess.
- * @return The SDL surface for the princess sprite.
+ * @return The sprite for the princess sprite.
  */
-SDL_Surface *sprites_get_princess(struct sprites *sprites);
+struct sprite *sprites_get_princess(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for the player in a specific direction.
  * @param direction The direction of the player.
- * @return The SDL surface for the player sprite in the specified direction.
+ * @return The sprite for the player sprite in the specified direction.
  */
-SDL_Surface *sprites_get_player(struct sprites *sprites, enum direction direction);
+struct sprite *sprites_get_player(struct sprites *sprites, enum direction direction);
 
 /**
  * @brief Get the sprite for a bonus of a specific type.
  * @param bonus_type The type of bonus.
- * @return The SDL surface for the bonus sprite of the specified type.
+ * @return The sprite for the bonus sprite of the specified type.
  */
-SDL_Surface *sprites_get_bonus(struct sprites *sprites, enum bonus_type bonus_type);
+struct sprite *sprites_get_bonus(struct sprites *sprites, enum bonus_type bonus_type);
 
 /**
  * @brief Get the sprite for a tree.
- * @return The SDL surface for the tree sprite.
+ * @return The sprite for the tree sprite.
  */
-SDL_Surface *sprites_get_tree(struct sprites *sprites);
+struct sprite *sprites_get_tree(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for a box.
- * @return The SDL surface for the box sprite.
+ * @return The sprite for the box sprite.
  */
-SDL_Surface *sprites_get_box(struct sprites *sprites);
+struct sprite *sprites_get_box(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for a key.
- * @return The SDL surface for the key sprite.
+ * @return The sprite for the key sprite.
  */
-SDL_Surface *sprites_get_key(struct sprites *sprites);
+struct sprite *sprites_get_key(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for a stone.
- * @return The SDL surface for the stone sprite.
+ * @return The sprite for the stone sprite.
  */
-SDL_Surface *sprites_get_stone(struct sprites *sprites);
+struct sprite *sprites_get_stone(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for a door with a specific status.
  * @param status The status of the door.
- * @return The SDL surface for the door sprite with the specified status.
+ * @return The sprite for the door sprite with the specified status.
+ */
+struct sprite *sprites_get_door(struct sprites *sprites, enum door_status status);
+
+/**
+ * @brief Get the sprite for a digit, numbers are drawn one digit after the other.
+ * @param digit The digit to display, from 0 to 9.
+ * @return The sprite for the digit.
  */
-SDL_Surface *sprites_get_door(struct sprites *sprites, enum door_status status);
+struct sprite *sprites_get_digit(struct sprites *sprites, int digit);
 
 /**
- * @brief Get the sprite for a number.
- * @param number The number to display.
- * @return The SDL surface for the number sprite.
+ * @brief Get the sprite for a digit of a number drawn in the place of a single digit.
+ * The ten digits are scaled down once into a strip for each number of digits, kept until the tile size changes.
+ * @param digit The digit to display, from 0 to 9.
+ * @param num_digits The number of digits of the number, at most 10.
+ * @return The sprite for the digit, as wide as a digit divided by num_digits.
  */
-SDL_Surface *sprites_get_number(struct sprites *sprites, int number);
+struct sprite *sprites_get_small_digit(struct sprites *sprites, int digit, int num_digits);
 
 /**
  * @brief Get the sprite for the life banner.
- * @return The SDL surface for the life banner sprite.
+ * @return The sprite for the life banner sprite.
  */
-SDL_Surface *sprites_get_banner_life(struct sprites *sprites);
+struct sprite *sprites_get_banner_life(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for the bomb banner.
- * @return The SDL surface for the bomb banner sprite.
+ * @return The sprite for the bomb banner sprite.
  */
-SDL_Surface *sprites_get_banner_bomb(struct sprites *sprites);
+struct sprite *sprites_get_banner_bomb(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for the line banner.
- * @return The SDL surface for the line banner sprite.
+ * @return The sprite for the line banner sprite.
  */
-SDL_Surface *sprites_get_banner_line(struct sprites *sprites);
+struct sprite *sprites_get_banner_line(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for the vertical line banner.
- * @return The SDL surface for the vertical line banner sprite.
+ * @return The sprite for the vertical line banner sprite.
  */
-SDL_Surface *sprites_get_banner_vertical_line(struct sprites *sprites);
+struct sprite *sprites_get_banner_vertical_line(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for the range banner.
- * @return The SDL surface for the range banner sprite.
+ * @return The sprite for the range banner sprite.
  */
-SDL_Surface *sprites_get_banner_range(struct sprites *sprites);
+struct sprite *sprites_get_banner_range(struct sprites *sprites);
 
 /**
  * @brief Get the sprite for a bomb with a specific time to live.
  * @param bomb_state The state of the bomb.
- * @return The SDL surface for the bomb sprite with the specified time to live.
+ * @return The sprite for the bomb sprite with the specified time to live.
  */
-SDL_Surface *sprites_get_bomb(struct sprites *sprites, enum bomb_state bomb_state);
+struct sprite *sprites_get_bomb(struct sprites *sprites, enum bomb_state bomb_state);
 
 /**
  * @brief Get the sprite for a monster in a specific direction.
  * @param direction The direction of the monster.
- * @return The SDL surface for the monster sprite in the specified direction.
+ * @return The sprite for the monster sprite in the specified direction.
  */
-SDL_Surface *sprites_get_monster(struct sprites *sprites, enum direction direction);
+struct sprite *sprites_get_monster(struct sprites *sprites, enum direction direction);
 
 /**
  * @brief Get the sprite for a scenery of a specific type.
  * @param type The type of scenery.
- * @return The SDL surface for the scenery sprite of the specified type.
+ * @return The sprite for the scenery sprite of the specified type.
  */
-SDL_Surface *sprites_get_scenery(struct sprites *sprites, enum scenery_type type);
+struct sprite *sprites_get_scenery(struct sprites *sprites, enum scenery_type type);
 
 #endif /* SPRITES_H */
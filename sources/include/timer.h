@@ -1,8 +1,28 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "buffer.h"
 #include <stdio.h>
 
+/**
+ * @brief Advance the clock of the timers, which only moves with the game ticks so that a run can be replayed.
+ * Only called from the thread running the game, like all the timers.
+ * @param duration The duration of the tick in milliseconds.
+ */
+void timer_advance_clock(int duration);
+
+/**
+ * @brief Get the clock of the timers.
+ * @return The time of the game in milliseconds.
+ */
+long timer_get_clock(void);
+
+/**
+ * @brief Set the clock of the timers, to the one of a saved state before reading its timers.
+ * @param time The time of the game in milliseconds.
+ */
+void timer_set_clock(long time);
+
 /**
  * @brief Initialize a timer.
  * @return A pointer to the initialized timer.
@@ -16,18 +36,32 @@ struct timer *timer_new();
 void timer_free(struct timer *timer);
 
 /**
- * @brief Write a timer to a file.
+ * @brief Write a timer to a buffer, in a compact form which doesn't depend on the platform.
  * @param timer The timer to write.
- * @param file The file to write the timer to.
+ * @param buffer The buffer to write the timer to.
  */
-void timer_write(struct timer *timer, FILE *file);
+void timer_serialize(struct timer *timer, struct buffer *buffer);
 
 /**
- * @brief Read a timer from a file.
- * @param file The file to read the timer from.
+ * @brief Read a timer written by timer_serialize.
+ * @param buffer The buffer to read the timer from.
  * @return A pointer to the timer read.
  */
-struct timer *timer_read(FILE *file);
+struct timer *timer_deserialize(struct buffer *buffer);
+
+/**
+ * @brief Copy a timer to a checkpoint, as it is in memory. Only read back by this process.
+ * @param timer The timer to copy.
+ * @param buffer The buffer to copy the timer to.
+ */
+void timer_checkpoint(struct timer *timer, struct buffer *buffer);
+
+/**
+ * @brief Restore a timer copied by timer_checkpoint, in place.
+ * @param timer The timer to restore.
+ * @param buffer The buffer to read the timer from.
+ */
+void timer_rollback(struct timer *timer, struct buffer *buffer);
 
 /**
  * @brief Get the duration of the timer.
@@ -43,6 +77,13 @@ int timer_get_duration(struct timer *timer);
  */
 int timer_get_remaining(struct timer *timer);
 
+/**
+ * @brief Get the time elapsed since the timer was started, which goes on once it is over.
+ * @param timer The timer to get the elapsed time from.
+ * @return The elapsed time in milliseconds, on the clock of the timers.
+ */
+int timer_get_elapsed(struct timer *timer);
+
 /**
  * @brief Set the start time of the timer.
  * @param timer The timer to set the start time for.
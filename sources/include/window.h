@@ -1,6 +1,7 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
+#include "sprites.h"
 #include <SDL/SDL.h>
 
 /**
@@ -10,6 +11,16 @@
  */
 SDL_Surface *window_create(int width, int height);
 
+/**
+ * @brief Give the game window the specified width and height.
+ * The video mode is only set again when the dimensions change, otherwise the window is reused as is.
+ * @param window The game window.
+ * @param width The width of the window.
+ * @param height The height of the window.
+ * @return The resized game window.
+ */
+SDL_Surface *window_resize(SDL_Surface *window, int width, int height);
+
 /**
  * @brief Free the game window.
  */
@@ -22,12 +33,22 @@ void window_refresh(SDL_Surface *window);
 
 /**
  * @brief Display an SDL surface at the specified location.
+ * Surfaces in the format of the window are drawn by the blit kernels, the others by SDL_BlitSurface.
  * @param surface The SDL surface to display.
  * @param x The x-coordinate of the location.
  * @param y The y-coordinate of the location.
  */
 void window_display_image(SDL_Surface *window, SDL_Surface *surface, int x, int y);
 
+/**
+ * @brief Display a sprite at the specified location.
+ * Sprites in the format of the window are drawn by the blit kernels, the others by SDL_BlitSurface.
+ * @param sprite The sprite to display.
+ * @param x The x-coordinate of the location.
+ * @param y The y-coordinate of the location.
+ */
+void window_display_sprite(SDL_Surface *window, struct sprite *sprite, int x, int y);
+
 /**
  * @brief Set every pixel of the window to white.
  */
@@ -0,0 +1,449 @@
+#include "../include/asset.h"
+#include "../include/misc.h"
+#include <SDL/SDL_image.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Maximum number of threads decoding images in parallel.
+ */
+#define MAX_DECODE_WORKERS 8
+
+/**
+ * @brief Structure representing a decoded image.
+ */
+struct asset {
+    uint64_t hash; /**< FNV-1a hash of the file content */
+    long size; /**< Size of the file content */
+    unsigned char *content; /**< File content, compared when another file has the same hash */
+    SDL_Surface *surface; /**< Decoded image */
+    int num_refs; /**< Number of references to the image */
+    struct asset *next; /**< Pointer to the next asset */
+};
+
+/**
+ * @brief Structure mapping a path to a decoded image.
+ */
+struct asset_path {
+    char *filename; /**< Path of the image file */
+    struct asset *asset; /**< Image decoded from this file */
+    struct asset_path *next; /**< Pointer to the next path */
+};
+
+/**
+ * @brief Structure representing the asset cache.
+ */
+struct asset_cache {
+    struct asset *asset_head; /**< Head of the decoded images' linked list */
+    struct asset_path *path_head; /**< Head of the known paths' linked list */
+};
+
+/**
+ * @brief Structure representing an image file to decode on a worker thread.
+ */
+struct decode_job {
+    const char *filename; /**< Path of the image file */
+    uint64_t hash; /**< FNV-1a hash of the file content */
+    long size; /**< Size of the file content */
+    unsigned char *content; /**< File content */
+    SDL_Surface *surface; /**< Decoded image */
+    char error[256]; /**< Why the image couldn't be decoded, empty if it was */
+};
+
+/**
+ * @brief Structure shared by the decoding worker threads.
+ */
+struct decode_queue {
+    struct decode_job *jobs; /**< Images to decode */
+    int num_jobs; /**< Number of images to decode */
+    int next_job; /**< Index of the next image to decode */
+    SDL_mutex *mutex; /**< Mutex protecting next_job */
+};
+
+struct asset_cache *asset_cache_new(void) {
+    struct asset_cache *cache = malloc(sizeof(struct asset_cache));
+
+    if (!cache) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(cache, 0, sizeof(struct asset_cache));
+
+    // initialize the decoders once, on this thread, before any worker uses them
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG);
+
+    return cache;
+}
+
+static void remove_paths(struct asset_cache *cache, struct asset *asset) {
+    assert(cache);
+
+    struct asset_path **link = &cache->path_head;
+
+    while (*link != NULL) {
+        struct asset_path *current = *link;
+
+        if (asset == NULL || current->asset == asset) {
+            *link = current->next;
+            free(current->filename);
+            free(current);
+        } else {
+            link = &current->next;
+        }
+    }
+}
+
+void asset_cache_free(struct asset_cache *cache) {
+    assert(cache);
+
+    remove_paths(cache, NULL);
+
+    struct asset *current = cache->asset_head;
+
+    while (current != NULL) {
+        struct asset *next = current->next;
+        SDL_FreeSurface(current->surface);
+        free(current->content);
+        free(current);
+        current = next;
+    }
+
+    IMG_Quit();
+    free(cache);
+}
+
+static void add_path(struct asset_cache *cache, const char *filename, struct asset *asset) {
+    assert(cache);
+    assert(filename);
+    assert(asset);
+
+    struct asset_path *path = malloc(sizeof(struct asset_path));
+
+    if (!path) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    path->filename = malloc(strlen(filename) + 1);
+
+    if (!path->filename) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(path->filename, filename);
+    path->asset = asset;
+    path->next = cache->path_head;
+    cache->path_head = path;
+}
+
+static uint64_t hash_content(const unsigned char *data, long size) {
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (long i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static unsigned char *read_file(const char *filename, long *size) {
+    assert(filename);
+    assert(size);
+
+    FILE *file = fopen(filename, "rb");
+
+    if (!file) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = malloc(*size > 0 ? *size : 1);
+
+    if (!data) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    size_t num_read = fread(data, 1, *size, file);
+
+    fclose(file);
+
+    if (num_read != (size_t) *size) {
+        free(data);
+        return NULL;
+    }
+
+
+    return data;
+}
+
+static SDL_Surface *decode_image(const unsigned char *data, long size) {
+    assert(data);
+
+    return IMG_Load_RW(SDL_RWFromConstMem(data, (int) size), 1);
+}
+
+static struct asset *find_asset_by_path(struct asset_cache *cache, const char *filename) {
+    assert(cache);
+    assert(filename);
+
+    for (struct asset_path *current = cache->path_head; current != NULL; current = current->next) {
+        if (strcmp(current->filename, filename) == 0) {
+            return current->asset;
+        }
+    }
+
+    return NULL;
+}
+
+static struct asset *find_asset_by_content(struct asset_cache *cache, uint64_t hash, const unsigned char *content, long size) {
+    assert(cache);
+    assert(content);
+
+    // the hash only narrows the search, a collision mustn't share another image
+    for (struct asset *current = cache->asset_head; current != NULL; current = current->next) {
+        if (current->hash == hash && current->size == size && memcmp(current->content, content, size) == 0) {
+            return current;
+        }
+    }
+
+    return NULL;
+}
+
+static struct asset *add_asset(struct asset_cache *cache, uint64_t hash, unsigned char *content, long size, SDL_Surface *surface) {
+    assert(cache);
+    assert(content);
+    assert(surface);
+
+    struct asset *asset = malloc(sizeof(struct asset));
+
+    if (!asset) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    asset->hash = hash;
+    asset->size = size;
+    asset->content = content;
+    asset->surface = surface;
+    asset->num_refs = 0;
+    asset->next = cache->asset_head;
+    cache->asset_head = asset;
+
+    return asset;
+}
+
+SDL_Surface *asset_cache_load(struct asset_cache *cache, const char *filename) {
+    assert(cache);
+    assert(filename);
+
+    struct asset *asset = find_asset_by_path(cache, filename);
+
+    if (!asset) {
+        long size;
+        unsigned char *data = read_file(filename, &size);
+
+        if (!data) {
+            error("Can't read image %s\n", filename);
+        }
+
+        uint64_t hash = hash_content(data, size);
+
+        // a different path with the same content shares the already decoded image
+        asset = find_asset_by_content(cache, hash, data, size);
+
+        if (asset) {
+            free(data);
+        } else {
+            SDL_Surface *surface = decode_image(data, size);
+
+            if (!surface) {
+                error("IMG_Load %s: %s\n", filename, IMG_GetError());
+            }
+
+            asset = add_asset(cache, hash, data, size, surface);
+        }
+
+        add_path(cache, filename, asset);
+    }
+
+    asset->num_refs++;
+
+    return asset->surface;
+}
+
+static int decode_worker(void *data) {
+    struct decode_queue *queue = data;
+
+    for (;;) {
+        SDL_LockMutex(queue->mutex);
+        int index = queue->next_job++;
+        SDL_UnlockMutex(queue->mutex);
+
+        if (index >= queue->num_jobs) {
+            return 0;
+        }
+
+        struct decode_job *job = &queue->jobs[index];
+        job->content = read_file(job->filename, &job->size);
+
+        // the thread waiting for the workers reports the failure, the others are still running
+        if (!job->content) {
+            snprintf(job->error, sizeof(job->error), "Can't read image %s\n", job->filename);
+            continue;
+        }
+
+        job->hash = hash_content(job->content, job->size);
+        job->surface = decode_image(job->content, job->size);
+
+        if (!job->surface) {
+            snprintf(job->error, sizeof(job->error), "IMG_Load %s: %s\n", job->filename, IMG_GetError());
+        }
+    }
+}
+
+static int is_job_queued(struct decode_queue *queue, const char *filename) {
+    assert(queue);
+
+    for (int i = 0; i < queue->num_jobs; i++) {
+        if (strcmp(queue->jobs[i].filename, filename) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void asset_cache_preload(struct asset_cache *cache, const char **filenames, int num_filenames) {
+    assert(cache);
+    assert(filenames);
+
+    struct decode_queue queue;
+
+    memset(&queue, 0, sizeof(struct decode_queue));
+
+    queue.jobs = malloc((num_filenames > 0 ? num_filenames : 1) * sizeof(struct decode_job));
+
+    if (!queue.jobs) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < num_filenames; i++) {
+        if (!find_asset_by_path(cache, filenames[i]) && !is_job_queued(&queue, filenames[i])) {
+            memset(&queue.jobs[queue.num_jobs], 0, sizeof(struct decode_job));
+            queue.jobs[queue.num_jobs].filename = filenames[i];
+            queue.num_jobs++;
+        }
+    }
+
+    queue.mutex = SDL_CreateMutex();
+
+    int num_workers = get_num_processors();
+
+    if (num_workers > MAX_DECODE_WORKERS) {
+        num_workers = MAX_DECODE_WORKERS;
+    }
+
+    if (num_workers > queue.num_jobs) {
+        num_workers = queue.num_jobs;
+    }
+
+    SDL_Thread *workers[MAX_DECODE_WORKERS];
+
+    for (int i = 1; i < num_workers; i++) {
+        workers[i] = SDL_CreateThread(decode_worker, &queue);
+
+        if (!workers[i]) {
+            error("Can't create decoding thread: %s\n", SDL_GetError());
+        }
+    }
+
+    // the calling thread decodes too, then waits for every worker
+    decode_worker(&queue);
+
+    for (int i = 1; i < num_workers; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+
+    SDL_DestroyMutex(queue.mutex);
+
+    for (int i = 0; i < queue.num_jobs; i++) {
+        if (queue.jobs[i].error[0]) {
+            error("%s", queue.jobs[i].error);
+        }
+    }
+
+    for (int i = 0; i < queue.num_jobs; i++) {
+        struct decode_job *job = &queue.jobs[i];
+        struct asset *asset = find_asset_by_content(cache, job->hash, job->content, job->size);
+
+        if (asset) {
+            SDL_FreeSurface(job->surface);
+            free(job->content);
+        } else {
+            asset = add_asset(cache, job->hash, job->content, job->size, job->surface);
+        }
+
+        add_path(cache, job->filename, asset);
+    }
+
+    free(queue.jobs);
+}
+
+void asset_cache_release(struct asset_cache *cache, SDL_Surface *surface) {
+    assert(cache);
+    assert(surface);
+
+    for (struct asset **link = &cache->asset_head; *link != NULL; link = &(*link)->next) {
+        struct asset *current = *link;
+
+        if (current->surface != surface) {
+            continue;
+        }
+
+        if (--current->num_refs == 0) {
+            *link = current->next;
+            remove_paths(cache, current);
+            SDL_FreeSurface(current->surface);
+            free(current->content);
+            free(current);
+        }
+
+        return;
+    }
+
+    assert(0 && "surface not loaded through the asset cache");
+}
+
+int asset_cache_get_num_assets(struct asset_cache *cache) {
+    assert(cache);
+
+    int num_assets = 0;
+
+    for (struct asset *current = cache->asset_head; current != NULL; current = current->next) {
+        num_assets++;
+    }
+
+    return num_assets;
+}
+
+size_t asset_cache_get_resident_memory(struct asset_cache *cache) {
+    assert(cache);
+
+    size_t memory = 0;
+
+    for (struct asset *current = cache->asset_head; current != NULL; current = current->next) {
+        memory += (size_t) current->surface->pitch * current->surface->h + (size_t) current->size;
+    }
+
+    return memory;
+}
@@ -0,0 +1,181 @@
+#include "../include/autosave.h"
+#include "../include/misc.h"
+#include <SDL/SDL.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * @brief Suffix of the temporary file a save is written to before being renamed.
+ */
+#define AUTOSAVE_TEMPORARY_SUFFIX ".tmp"
+
+/**
+ * @brief Structure representing the thread writing the saves.
+ */
+struct autosave {
+    char *filename; /**< Path to the save file */
+    char *temporary_filename; /**< Path to the file a save is written to before being renamed */
+    struct buffer *buffer; /**< Save handed to the thread, owned by the thread between a commit and the next begin */
+    int append; /**< Is the buffer appended to the file ? */
+    int has_base; /**< Were the last whole save and the changes since written ? Only read between a begin and a commit */
+    SDL_Thread *thread; /**< The thread */
+    SDL_sem *start; /**< Posted when a save is committed */
+    SDL_sem *idle; /**< Posted by the thread when the save is written */
+    int quit; /**< Set to stop the thread */
+};
+
+static int write_save(struct autosave *autosave) {
+    assert(autosave);
+
+    // changes go straight to the end of the file, a whole save to a temporary file first
+    const char *filename = autosave->append ? autosave->filename : autosave->temporary_filename;
+    FILE *file = fopen(filename, autosave->append ? "ab" : "wb");
+
+    if (!file) {
+        perror("fopen autosave");
+        return 0;
+    }
+
+    size_t size = buffer_get_size(autosave->buffer);
+    int is_written = fwrite(buffer_get_data(autosave->buffer), 1, size, file) == size;
+
+    // the data reaches the disk before the rename makes it the save
+    is_written = is_written && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    is_written = fclose(file) == 0 && is_written;
+
+    if (is_written && !autosave->append) {
+        is_written = rename(autosave->temporary_filename, autosave->filename) == 0;
+    }
+
+    if (!is_written) {
+        perror("write autosave");
+
+        if (!autosave->append) {
+            remove(autosave->temporary_filename);
+        }
+    }
+
+    return is_written;
+}
+
+static int autosave_run(void *data) {
+    struct autosave *autosave = data;
+
+    assert(autosave);
+
+    for (;;) {
+        SDL_SemWait(autosave->start);
+
+        if (autosave->quit) {
+            return 0;
+        }
+
+        // changes lost on the way can't be appended to, the next save is a whole one
+        if (!write_save(autosave)) {
+            autosave->has_base = 0;
+        } else {
+            autosave->has_base = autosave->has_base || !autosave->append;
+        }
+
+        SDL_SemPost(autosave->idle);
+    }
+}
+
+struct autosave *autosave_new(const char *filename) {
+    assert(filename);
+
+    struct autosave *autosave = malloc(sizeof(struct autosave));
+
+    if (!autosave) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(autosave, 0, sizeof(struct autosave));
+
+    size_t length = strlen(filename);
+
+    autosave->filename = malloc(length + 1);
+    autosave->temporary_filename = malloc(length + sizeof(AUTOSAVE_TEMPORARY_SUFFIX));
+
+    if (!autosave->filename || !autosave->temporary_filename) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(autosave->filename, filename);
+    strcpy(autosave->temporary_filename, filename);
+    strcat(autosave->temporary_filename, AUTOSAVE_TEMPORARY_SUFFIX);
+
+    autosave->buffer = buffer_new();
+    autosave->start = SDL_CreateSemaphore(0);
+    autosave->idle = SDL_CreateSemaphore(1);
+    autosave->thread = SDL_CreateThread(autosave_run, autosave);
+
+    if (!autosave->thread) {
+        error("Can't create autosave thread: %s\n", SDL_GetError());
+    }
+
+    return autosave;
+}
+
+void autosave_free(struct autosave *autosave) {
+    assert(autosave);
+
+    SDL_SemWait(autosave->idle);
+
+    autosave->quit = 1;
+    SDL_SemPost(autosave->start);
+    SDL_WaitThread(autosave->thread, NULL);
+
+    SDL_DestroySemaphore(autosave->start);
+    SDL_DestroySemaphore(autosave->idle);
+    buffer_free(autosave->buffer);
+    free(autosave->filename);
+    free(autosave->temporary_filename);
+    free(autosave);
+}
+
+struct buffer *autosave_begin(struct autosave *autosave, int wait) {
+    assert(autosave);
+
+    if (wait) {
+        SDL_SemWait(autosave->idle);
+    } else if (SDL_SemTryWait(autosave->idle) != 0) {
+        return NULL;
+    }
+
+    buffer_clear(autosave->buffer);
+
+    return autosave->buffer;
+}
+
+void autosave_commit(struct autosave *autosave, int append) {
+    assert(autosave);
+
+    autosave->append = append;
+    SDL_SemPost(autosave->start);
+}
+
+int autosave_has_base(struct autosave *autosave) {
+    assert(autosave);
+
+    return autosave->has_base;
+}
+
+void autosave_flush(struct autosave *autosave) {
+    assert(autosave);
+
+    SDL_SemWait(autosave->idle);
+    SDL_SemPost(autosave->idle);
+}
+
+void autosave_discard(struct autosave *autosave) {
+    assert(autosave);
+
+    SDL_SemWait(autosave->idle);
+    remove(autosave->filename);
+    SDL_SemPost(autosave->idle);
+}
@@ -0,0 +1,33 @@
+#include "../include/backend.h"
+#include <assert.h>
+#include <string.h>
+
+/**
+ * @brief Name of each action in scripts, indexed by action.
+ */
+static const char *action_names[NUM_ACTIONS] = {
+    [ACTION_NONE] = NULL,
+    [ACTION_NORTH] = "UP",
+    [ACTION_SOUTH] = "DOWN",
+    [ACTION_EAST] = "RIGHT",
+    [ACTION_WEST] = "LEFT",
+    [ACTION_BOMB] = "BOMB",
+    [ACTION_OPEN] = "OPEN",
+    [ACTION_PAUSE] = "PAUSE",
+    [ACTION_SAVE] = "SAVE",
+    [ACTION_QUIT] = "QUIT",
+    [ACTION_BACK] = "BACK",
+    [ACTION_FORWARD] = "FORWARD"
+};
+
+enum action backend_get_action(const char *name) {
+    assert(name);
+
+    for (int i = ACTION_NONE + 1; i < NUM_ACTIONS; i++) {
+        if (strcmp(action_names[i], name) == 0) {
+            return (enum action) i;
+        }
+    }
+
+    return ACTION_NONE;
+}
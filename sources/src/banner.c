@@ -0,0 +1,168 @@
+#include "../include/banner.h"
+#include "../include/window.h"
+#include "../include/misc.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @enum banner_value
+ * @brief Represents the numbers displayed in the banner.
+ */
+enum banner_value {
+    BANNER_LEVEL, /**< Number of the current level */
+    BANNER_LIVES, /**< Number of lives of the player */
+    BANNER_BOMBS, /**< Number of bombs of the player */
+    BANNER_RANGE, /**< Range of the bombs of the player */
+    BANNER_KEYS, /**< Number of keys of the player */
+    NUM_BANNER_VALUES /**< Number of values, not a value */
+};
+
+/**
+ * @brief Structure representing the banner.
+ */
+struct banner {
+    SDL_Surface *surface; /**< Pre-composited banner, built on first display */
+    int width; /**< Number of cells the banner spans */
+    int tile_size; /**< Size of a cell in pixels the banner was composited at */
+    int values[NUM_BANNER_VALUES]; /**< Numbers the banner was composited with */
+};
+
+struct banner *banner_new(void) {
+    struct banner *banner = malloc(sizeof(struct banner));
+
+    if (!banner) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(banner, 0, sizeof(struct banner));
+
+    return banner;
+}
+
+void banner_free(struct banner *banner) {
+    assert(banner);
+
+    if (banner->surface) {
+        SDL_FreeSurface(banner->surface);
+    }
+
+    free(banner);
+}
+
+static void display_sprite(struct banner *banner, struct sprite *sprite, int x, int y) {
+    assert(banner);
+    assert(sprite);
+
+    window_display_sprite(banner->surface, sprite, sprites_scale_length(x, banner->tile_size), sprites_scale_length(y, banner->tile_size));
+}
+
+static void display_number(struct banner *banner, struct sprites *sprites, int number, int x, int y) {
+    assert(banner);
+    assert(number >= 0);
+
+    int num_digits = 1;
+
+    for (int rest = number / 10; rest > 0; rest /= 10) {
+        num_digits++;
+    }
+
+    // the digits share the place of a single one, scaled down and centered vertically
+    int height = sprites_get_digit(sprites, 0)->rect.h;
+    int digit_x = sprites_scale_length(x, banner->tile_size);
+    int digit_y = sprites_scale_length(y, banner->tile_size);
+
+    for (int i = num_digits - 1; i >= 0; i--, number /= 10) {
+        struct sprite *digit = sprites_get_small_digit(sprites, number % 10, num_digits);
+
+        window_display_sprite(banner->surface, digit, digit_x + i * digit->rect.w, digit_y + (height - digit->rect.h) / 2);
+    }
+}
+
+static void build_surface(struct banner *banner, struct sprites *sprites) {
+    assert(banner);
+    assert(sprites);
+    assert(SDL_GetVideoSurface());
+
+    int width = sprites_scale_length(banner->width * SIZE_BLOC, banner->tile_size);
+    int height = sprites_scale_length(BANNER_HEIGHT + LINE_HEIGHT, banner->tile_size);
+
+    if (!banner->surface || banner->surface->w != width || banner->surface->h != height) {
+        SDL_PixelFormat *format = SDL_GetVideoSurface()->format;
+
+        if (banner->surface) {
+            SDL_FreeSurface(banner->surface);
+        }
+
+        banner->surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, format->BitsPerPixel, format->Rmask, format->Gmask, format->Bmask, format->Amask);
+
+        if (!banner->surface) {
+            error("Can't create banner: %s\n", SDL_GetError());
+        }
+    }
+
+    window_clear(banner->surface);
+
+    for (int i = 0; i < banner->width; i++) {
+        display_sprite(banner, sprites_get_banner_line(sprites), i * SIZE_BLOC, 0);
+    }
+
+    int white_bloc = 0.5 * SIZE_BLOC;
+    int y = LINE_HEIGHT;
+
+    display_number(banner, sprites, banner->values[BANNER_LEVEL], 0, y);
+    display_sprite(banner, sprites_get_banner_vertical_line(sprites), SIZE_BLOC, y);
+
+    display_sprite(banner, sprites_get_banner_life(sprites), white_bloc + SIZE_BLOC + LINE_HEIGHT, y);
+    display_number(banner, sprites, banner->values[BANNER_LIVES], white_bloc + 2 * SIZE_BLOC + LINE_HEIGHT, y);
+
+    display_sprite(banner, sprites_get_banner_bomb(sprites), 2 * white_bloc + 3 * SIZE_BLOC + LINE_HEIGHT, y);
+    display_number(banner, sprites, banner->values[BANNER_BOMBS], 2 * white_bloc + 4 * SIZE_BLOC + LINE_HEIGHT, y);
+
+    display_sprite(banner, sprites_get_banner_range(sprites), 3 * white_bloc + 5 * SIZE_BLOC + LINE_HEIGHT, y);
+    display_number(banner, sprites, banner->values[BANNER_RANGE], 3 * white_bloc + 6 * SIZE_BLOC + LINE_HEIGHT, y);
+
+    display_sprite(banner, sprites_get_key(sprites), 4 * white_bloc + 7 * SIZE_BLOC + LINE_HEIGHT, y);
+    display_number(banner, sprites, banner->values[BANNER_KEYS], 4 * white_bloc + 8 * SIZE_BLOC + LINE_HEIGHT, y);
+}
+
+void banner_display(struct banner *banner, struct render_queue *queue, struct sprites *sprites, struct camera *camera, const struct snapshot *snapshot) {
+    assert(banner);
+    assert(queue);
+    assert(sprites);
+    assert(camera);
+    assert(snapshot);
+
+    int values[NUM_BANNER_VALUES];
+
+    values[BANNER_LEVEL] = snapshot->level + 1;
+    values[BANNER_LIVES] = snapshot->num_lives;
+    values[BANNER_BOMBS] = snapshot->num_bombs;
+    values[BANNER_RANGE] = snapshot->range_bombs;
+    values[BANNER_KEYS] = snapshot->num_keys;
+
+    int width = camera_get_width(camera);
+    int tile_size = sprites_get_tile_size(sprites);
+
+    // the counters rarely change: most frames reuse the banner composited for a previous one
+    if (!banner->surface || banner->width != width || banner->tile_size != tile_size || memcmp(banner->values, values, sizeof(values)) != 0) {
+        banner->width = width;
+        banner->tile_size = tile_size;
+        memcpy(banner->values, values, sizeof(values));
+
+        build_surface(banner, sprites);
+    }
+
+    struct sprite sprite;
+
+    sprite.surface = banner->surface;
+    sprite.rect.x = 0;
+    sprite.rect.y = 0;
+    sprite.rect.w = (Uint16) banner->surface->w;
+    sprite.rect.h = (Uint16) banner->surface->h;
+
+    render_queue_push(queue, &sprite, 0, camera_get_height(camera) * SIZE_BLOC, LAYER_BANNER);
+}
@@ -0,0 +1,449 @@
+#include "../include/blit.h"
+#include "../include/constant.h"
+#include "../include/misc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLIT_X86
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Kernel blending a row of pixels.
+ */
+typedef void (*row_kernel)(Uint32 *dst, const Uint32 *src, int width);
+
+static void blend_row_c(Uint32 *dst, const Uint32 *src, int width) {
+    for (int i = 0; i < width; i++) {
+        Uint32 s = src[i];
+        Uint32 alpha = s >> 24;
+
+        // same arithmetic as SDL's per-pixel alpha blitter, two channels at once
+        if (alpha == SDL_ALPHA_OPAQUE) {
+            dst[i] = (s & 0x00ffffff) | (dst[i] & 0xff000000);
+        } else if (alpha) {
+            Uint32 d = dst[i];
+            Uint32 dalpha = d & 0xff000000;
+            Uint32 s1 = s & 0xff00ff;
+            Uint32 d1 = d & 0xff00ff;
+
+            d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+            s &= 0xff00;
+            d &= 0xff00;
+            d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+
+            dst[i] = d1 | d | dalpha;
+        }
+    }
+}
+
+#ifdef BLIT_X86
+
+/*
+ * The vector kernels compute exactly what blend_row_c computes, wrap-around included,
+ * so every kernel draws the same pixels. 32-bit products are built from 16-bit ones
+ * because SSE2 has no 32-bit multiplication.
+ */
+
+__attribute__((target("sse2")))
+static inline __m128i multiply_sse2(__m128i x, __m128i alpha) {
+    // alpha holds the same value in both 16-bit halves of each 32-bit lane
+    __m128i low = _mm_mullo_epi16(x, alpha);
+    __m128i high = _mm_mulhi_epu16(x, alpha);
+
+    return _mm_add_epi32(low, _mm_slli_epi32(high, 16));
+}
+
+__attribute__((target("sse2")))
+static inline void blend_sse2(Uint32 *dst, const Uint32 *src) {
+    const __m128i red_blue = _mm_set1_epi32(0xff00ff);
+    const __m128i green = _mm_set1_epi32(0xff00);
+    const __m128i alpha_mask = _mm_set1_epi32((int) 0xff000000);
+
+    __m128i s = _mm_loadu_si128((const __m128i *) src);
+    __m128i s_alpha = _mm_and_si128(s, alpha_mask);
+
+    // most tiles are made of runs of fully transparent or fully opaque pixels
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(s_alpha, _mm_setzero_si128())) == 0xffff) {
+        return;
+    }
+
+    __m128i d = _mm_loadu_si128((const __m128i *) dst);
+    __m128i opaque = _mm_or_si128(_mm_andnot_si128(alpha_mask, s), _mm_and_si128(d, alpha_mask));
+    __m128i is_opaque = _mm_cmpeq_epi32(s_alpha, alpha_mask);
+
+    if (_mm_movemask_epi8(is_opaque) == 0xffff) {
+        _mm_storeu_si128((__m128i *) dst, opaque);
+        return;
+    }
+
+    __m128i a = _mm_srli_epi32(s, 24);
+    __m128i alpha = _mm_or_si128(a, _mm_slli_epi32(a, 16));
+
+    __m128i s1 = _mm_and_si128(s, red_blue);
+    __m128i d1 = _mm_and_si128(d, red_blue);
+    __m128i rb = _mm_and_si128(_mm_add_epi32(d1, _mm_srli_epi32(multiply_sse2(_mm_sub_epi32(s1, d1), alpha), 8)), red_blue);
+
+    __m128i s2 = _mm_and_si128(s, green);
+    __m128i d2 = _mm_and_si128(d, green);
+    __m128i g = _mm_and_si128(_mm_add_epi32(d2, _mm_srli_epi32(multiply_sse2(_mm_sub_epi32(s2, d2), alpha), 8)), green);
+
+    // fully transparent pixels give back d through the formula
+    __m128i blended = _mm_or_si128(_mm_or_si128(rb, g), _mm_and_si128(d, alpha_mask));
+
+    _mm_storeu_si128((__m128i *) dst, _mm_or_si128(_mm_and_si128(is_opaque, opaque), _mm_andnot_si128(is_opaque, blended)));
+}
+
+__attribute__((target("sse2")))
+static void blend_row_sse2(Uint32 *dst, const Uint32 *src, int width) {
+    int i = 0;
+
+    for (; i + 4 <= width; i += 4) {
+        blend_sse2(dst + i, src + i);
+    }
+
+    blend_row_c(dst + i, src + i, width - i);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i multiply_avx2(__m256i x, __m256i alpha) {
+    __m256i low = _mm256_mullo_epi16(x, alpha);
+    __m256i high = _mm256_mulhi_epu16(x, alpha);
+
+    return _mm256_add_epi32(low, _mm256_slli_epi32(high, 16));
+}
+
+__attribute__((target("avx2")))
+static inline void blend_avx2(Uint32 *dst, const Uint32 *src) {
+    const __m256i red_blue = _mm256_set1_epi32(0xff00ff);
+    const __m256i green = _mm256_set1_epi32(0xff00);
+    const __m256i alpha_mask = _mm256_set1_epi32((int) 0xff000000);
+
+    __m256i s = _mm256_loadu_si256((const __m256i *) src);
+    __m256i s_alpha = _mm256_and_si256(s, alpha_mask);
+
+    if (_mm256_testz_si256(s, alpha_mask)) {
+        return;
+    }
+
+    __m256i d = _mm256_loadu_si256((const __m256i *) dst);
+    __m256i opaque = _mm256_or_si256(_mm256_andnot_si256(alpha_mask, s), _mm256_and_si256(d, alpha_mask));
+    __m256i is_opaque = _mm256_cmpeq_epi32(s_alpha, alpha_mask);
+
+    if (_mm256_movemask_epi8(is_opaque) == -1) {
+        _mm256_storeu_si256((__m256i *) dst, opaque);
+        return;
+    }
+
+    __m256i a = _mm256_srli_epi32(s, 24);
+    __m256i alpha = _mm256_or_si256(a, _mm256_slli_epi32(a, 16));
+
+    __m256i s1 = _mm256_and_si256(s, red_blue);
+    __m256i d1 = _mm256_and_si256(d, red_blue);
+    __m256i rb = _mm256_and_si256(_mm256_add_epi32(d1, _mm256_srli_epi32(multiply_avx2(_mm256_sub_epi32(s1, d1), alpha), 8)), red_blue);
+
+    __m256i s2 = _mm256_and_si256(s, green);
+    __m256i d2 = _mm256_and_si256(d, green);
+    __m256i g = _mm256_and_si256(_mm256_add_epi32(d2, _mm256_srli_epi32(multiply_avx2(_mm256_sub_epi32(s2, d2), alpha), 8)), green);
+
+    __m256i blended = _mm256_or_si256(_mm256_or_si256(rb, g), _mm256_and_si256(d, alpha_mask));
+
+    _mm256_storeu_si256((__m256i *) dst, _mm256_blendv_epi8(blended, opaque, is_opaque));
+}
+
+__attribute__((target("avx2")))
+static void blend_row_avx2(Uint32 *dst, const Uint32 *src, int width) {
+    int i = 0;
+
+    for (; i + 8 <= width; i += 8) {
+        blend_avx2(dst + i, src + i);
+    }
+
+    // a tile row of 60 pixels ends with 4 pixels: the 128-bit kernel, inlined here so that
+    // it doesn't mix SSE and AVX encodings
+    if (i + 4 <= width) {
+        blend_sse2(dst + i, src + i);
+        i += 4;
+    }
+
+    blend_row_c(dst + i, src + i, width - i);
+}
+
+#endif /* BLIT_X86 */
+
+/**
+ * @brief Structure holding the row kernels in use.
+ */
+static struct {
+    enum blit_isa isa; /**< Instruction set of the kernels */
+    row_kernel blend_row; /**< Kernel blending pixels with their alpha channel */
+} kernels = {BLIT_C, blend_row_c};
+
+int blit_is_isa_supported(enum blit_isa isa) {
+#ifdef BLIT_X86
+    __builtin_cpu_init();
+
+    switch (isa) {
+        case BLIT_C:
+            return 1;
+
+        case BLIT_SSE2:
+            return __builtin_cpu_supports("sse2");
+
+        case BLIT_AVX2:
+            return __builtin_cpu_supports("avx2");
+    }
+
+    return 0;
+#else
+    return isa == BLIT_C;
+#endif
+}
+
+int blit_set_isa(enum blit_isa isa) {
+    if (!blit_is_isa_supported(isa)) {
+        return 0;
+    }
+
+    kernels.isa = BLIT_C;
+    kernels.blend_row = blend_row_c;
+
+#ifdef BLIT_X86
+    if (isa == BLIT_SSE2) {
+        kernels.isa = BLIT_SSE2;
+        kernels.blend_row = blend_row_sse2;
+    } else if (isa == BLIT_AVX2) {
+        kernels.isa = BLIT_AVX2;
+        kernels.blend_row = blend_row_avx2;
+    }
+#endif
+
+    return 1;
+}
+
+void blit_init(void) {
+    if (!blit_set_isa(BLIT_AVX2) && !blit_set_isa(BLIT_SSE2)) {
+        blit_set_isa(BLIT_C);
+    }
+}
+
+enum blit_isa blit_get_isa(void) {
+    return kernels.isa;
+}
+
+const char *blit_get_isa_name(enum blit_isa isa) {
+    switch (isa) {
+        case BLIT_SSE2:
+            return "SSE2";
+
+        case BLIT_AVX2:
+            return "AVX2";
+
+        default:
+            return "C";
+    }
+}
+
+int blit_is_supported(SDL_Surface *source, SDL_Surface *destination) {
+    assert(source);
+    assert(destination);
+
+    SDL_PixelFormat *src = source->format;
+    SDL_PixelFormat *dst = destination->format;
+
+    if (src->BytesPerPixel != 4 || dst->BytesPerPixel != 4) {
+        return 0;
+    }
+
+    if (src->Rmask != dst->Rmask || src->Gmask != dst->Gmask || src->Bmask != dst->Bmask) {
+        return 0;
+    }
+
+    if (source->flags & SDL_SRCCOLORKEY) {
+        return 0;
+    }
+
+    if ((source->flags & SDL_SRCALPHA) && src->Amask != 0xff000000) {
+        return 0;
+    }
+
+    return 1;
+}
+
+void blit_sprite(SDL_Surface *destination, const SDL_Rect *clip, struct sprite *sprite, int x, int y) {
+    assert(destination);
+    assert(clip);
+    assert(sprite);
+    assert(blit_is_supported(sprite->surface, destination));
+
+    SDL_Surface *source = sprite->surface;
+
+    int left = x > clip->x ? x : clip->x;
+    int top = y > clip->y ? y : clip->y;
+    int right = x + sprite->rect.w < clip->x + clip->w ? x + sprite->rect.w : clip->x + clip->w;
+    int bottom = y + sprite->rect.h < clip->y + clip->h ? y + sprite->rect.h : clip->y + clip->h;
+
+    if (left < 0) {
+        left = 0;
+    }
+
+    if (top < 0) {
+        top = 0;
+    }
+
+    if (right > destination->w) {
+        right = destination->w;
+    }
+
+    if (bottom > destination->h) {
+        bottom = destination->h;
+    }
+
+    if (left >= right || top >= bottom) {
+        return;
+    }
+
+    int width = right - left;
+    int is_blended = (source->flags & SDL_SRCALPHA) != 0;
+
+    for (int row = top; row < bottom; row++) {
+        Uint32 *dst = (Uint32 *) ((Uint8 *) destination->pixels + row * destination->pitch) + left;
+        const Uint32 *src = (const Uint32 *) ((const Uint8 *) source->pixels + (sprite->rect.y + row - y) * source->pitch) + sprite->rect.x + left - x;
+
+        // the vectorized memcpy of the C library is the fastest copy of opaque rows
+        if (is_blended) {
+            kernels.blend_row(dst, src, width);
+        } else {
+            memcpy(dst, src, width * sizeof(Uint32));
+        }
+    }
+}
+
+void blit_fill(SDL_Surface *destination, const SDL_Rect *area, Uint32 color) {
+    assert(destination);
+    assert(area);
+    assert(destination->format->BytesPerPixel == 4);
+
+    for (int row = area->y; row < area->y + area->h; row++) {
+        Uint32 *dst = (Uint32 *) ((Uint8 *) destination->pixels + row * destination->pitch) + area->x;
+
+        for (int i = 0; i < area->w; i++) {
+            dst[i] = color;
+        }
+    }
+}
+
+static SDL_Surface *create_tile(SDL_Surface *window, struct sprite *sprite, int is_opaque) {
+    SDL_PixelFormat *format = window->format;
+    SDL_Surface *tile = SDL_CreateRGBSurface(SDL_SWSURFACE, SIZE_BLOC, SIZE_BLOC, 32, format->Rmask, format->Gmask, format->Bmask, is_opaque ? 0 : 0xff000000);
+
+    if (!tile) {
+        error("Can't create tile: %s\n", SDL_GetError());
+    }
+
+    // the pixels and the alpha channel of the sprite are copied as they are
+    Uint32 flags = sprite->surface->flags & SDL_SRCALPHA;
+
+    SDL_SetAlpha(sprite->surface, 0, SDL_ALPHA_OPAQUE);
+    SDL_BlitSurface(sprite->surface, &sprite->rect, tile, NULL);
+    SDL_SetAlpha(sprite->surface, flags, SDL_ALPHA_OPAQUE);
+    SDL_SetAlpha(tile, is_opaque ? 0 : SDL_SRCALPHA, SDL_ALPHA_OPAQUE);
+
+    return tile;
+}
+
+static Uint32 hash_tile(SDL_Surface *window) {
+    Uint32 hash = 2166136261u;
+
+    for (int row = 0; row < SIZE_BLOC; row++) {
+        const Uint8 *pixels = (const Uint8 *) window->pixels + row * window->pitch;
+
+        for (int i = 0; i < SIZE_BLOC * 4; i++) {
+            hash = (hash ^ pixels[i]) * 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+static void reset_tile(SDL_Surface *window, SDL_Surface *background) {
+    SDL_SetClipRect(window, NULL);
+    SDL_BlitSurface(background, NULL, window, NULL);
+}
+
+void blit_benchmark(struct sprite *opaque_sprite, struct sprite *alpha_sprite, SDL_Surface *window, int iterations) {
+    assert(opaque_sprite);
+    assert(alpha_sprite);
+    assert(window);
+    assert(iterations > 0);
+
+    if (window->format->BytesPerPixel != 4) {
+        printf("Tile benchmark: the window must have 32 bits per pixel\n");
+        return;
+    }
+
+    SDL_Surface *tiles[2] = {create_tile(window, opaque_sprite, 1), create_tile(window, alpha_sprite, 0)};
+    SDL_Surface *background = create_tile(window, opaque_sprite, 1);
+    const char *names[2] = {"opaque copy", "alpha blend"};
+    enum blit_isa isa = blit_get_isa();
+    SDL_Rect clip = {0, 0, SIZE_BLOC, SIZE_BLOC};
+
+    printf("Tile benchmark (%d blits of %dx%d tiles)\n", iterations, SIZE_BLOC, SIZE_BLOC);
+
+    for (int t = 0; t < 2; t++) {
+        struct sprite tile = {tiles[t], {0, 0, SIZE_BLOC, SIZE_BLOC}};
+
+        reset_tile(window, background);
+
+        Uint32 start = SDL_GetTicks();
+
+        for (int n = 0; n < iterations; n++) {
+            SDL_Rect place = {0, 0, 0, 0};
+            SDL_BlitSurface(tile.surface, &tile.rect, window, &place);
+        }
+
+        Uint32 sdl_duration = SDL_GetTicks() - start;
+
+        reset_tile(window, background);
+        SDL_BlitSurface(tile.surface, &tile.rect, window, NULL);
+        Uint32 sdl_hash = hash_tile(window);
+
+        printf("  %s, SDL_BlitSurface: %5u ms\n", names[t], sdl_duration);
+
+        // opaque rows are copied by memcpy whatever the instruction set
+        for (enum blit_isa kernel = BLIT_C; kernel <= (t == 0 ? BLIT_C : BLIT_AVX2); kernel++) {
+            if (!blit_set_isa(kernel)) {
+                continue;
+            }
+
+            reset_tile(window, background);
+            SDL_LockSurface(window);
+
+            start = SDL_GetTicks();
+
+            for (int n = 0; n < iterations; n++) {
+                blit_sprite(window, &clip, &tile, 0, 0);
+            }
+
+            Uint32 duration = SDL_GetTicks() - start;
+
+            SDL_UnlockSurface(window);
+
+            // one blit over the background gives the pixels to compare with SDL's
+            reset_tile(window, background);
+            SDL_LockSurface(window);
+            blit_sprite(window, &clip, &tile, 0, 0);
+            SDL_UnlockSurface(window);
+
+            printf("  %s, %-4s kernel     : %5u ms (x%.2f)%s\n", names[t], blit_get_isa_name(kernel), duration, duration ? (double) sdl_duration / duration : 0.0, hash_tile(window) == sdl_hash ? "" : " DIFFERENT PIXELS");
+        }
+    }
+
+    blit_set_isa(isa);
+
+    SDL_FreeSurface(background);
+    SDL_FreeSurface(tiles[1]);
+    SDL_FreeSurface(tiles[0]);
+}
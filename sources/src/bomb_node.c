@@ -52,16 +52,22 @@ void bomb_node_free(struct bomb_node *bomb_node) {
     free(bomb_node);
 }
 
-void bomb_node_write(struct bomb_node *bomb_node, FILE *file) {
+void bomb_node_serialize(struct bomb_node *bomb_node, struct buffer *buffer) {
     assert(bomb_node);
-    assert(file);
+    assert(buffer);
 
-    fwrite(bomb_node, sizeof(struct bomb_node), 1, file);
-    timer_write(bomb_node->timer, file);
+    buffer_write_int(buffer, bomb_node->x);
+    buffer_write_int(buffer, bomb_node->y);
+    buffer_write_int(buffer, bomb_node->state);
+    buffer_write_int(buffer, bomb_node->north_range);
+    buffer_write_int(buffer, bomb_node->south_range);
+    buffer_write_int(buffer, bomb_node->east_range);
+    buffer_write_int(buffer, bomb_node->west_range);
+    timer_serialize(bomb_node->timer, buffer);
 }
 
-struct bomb_node *bomb_node_read(FILE *file) {
-    assert(file);
+struct bomb_node *bomb_node_deserialize(struct buffer *buffer) {
+    assert(buffer);
 
     struct bomb_node *bomb_node = malloc(sizeof(struct bomb_node));
 
@@ -70,13 +76,42 @@ struct bomb_node *bomb_node_read(FILE *file) {
         exit(EXIT_FAILURE);
     }
 
-    fread(bomb_node, sizeof(struct bomb_node), 1, file);
-
-    bomb_node->timer = timer_read(file);
+    bomb_node->x = buffer_read_int(buffer);
+    bomb_node->y = buffer_read_int(buffer);
+    bomb_node->state = (enum bomb_state) buffer_read_int(buffer);
+    bomb_node->north_range = buffer_read_int(buffer);
+    bomb_node->south_range = buffer_read_int(buffer);
+    bomb_node->east_range = buffer_read_int(buffer);
+    bomb_node->west_range = buffer_read_int(buffer);
+    bomb_node->timer = timer_deserialize(buffer);
+    bomb_node->next = NULL;
 
     return bomb_node;
 }
 
+void bomb_node_checkpoint(struct bomb_node *bomb_node, struct buffer *buffer) {
+    assert(bomb_node);
+    assert(buffer);
+
+    buffer_write_bytes(buffer, bomb_node, sizeof(struct bomb_node));
+    timer_checkpoint(bomb_node->timer, buffer);
+}
+
+void bomb_node_rollback(struct bomb_node *bomb_node, struct buffer *buffer) {
+    assert(bomb_node);
+    assert(buffer);
+
+    struct timer *timer = bomb_node->timer;
+    struct bomb_node *next = bomb_node->next;
+
+    // the pointers copied are the ones of the node at the time of the checkpoint
+    buffer_read_bytes(buffer, bomb_node, sizeof(struct bomb_node));
+    bomb_node->timer = timer;
+    bomb_node->next = next;
+
+    timer_rollback(timer, buffer);
+}
+
 struct bomb_node *bomb_node_get_next(struct bomb_node *bomb_node) {
     assert(bomb_node);
     return bomb_node->next;
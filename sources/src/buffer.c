@@ -0,0 +1,275 @@
+#include "../include/buffer.h"
+#include "../include/misc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Number of bytes of a new buffer, enough for the state of a small game.
+ */
+#define BUFFER_INITIAL_CAPACITY 4096
+
+/**
+ * @brief Structure representing a buffer of bytes.
+ */
+struct buffer {
+    unsigned char *data; /**< Bytes of the buffer */
+    size_t size; /**< Number of bytes written */
+    size_t capacity; /**< Number of bytes data can hold */
+    size_t position; /**< Number of bytes read */
+};
+
+struct buffer *buffer_new(void) {
+    struct buffer *buffer = malloc(sizeof(struct buffer));
+
+    if (!buffer) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    buffer->data = malloc(BUFFER_INITIAL_CAPACITY);
+
+    if (!buffer->data) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    buffer->size = 0;
+    buffer->capacity = BUFFER_INITIAL_CAPACITY;
+    buffer->position = 0;
+
+    return buffer;
+}
+
+void buffer_free(struct buffer *buffer) {
+    assert(buffer);
+
+    free(buffer->data);
+    free(buffer);
+}
+
+void buffer_clear(struct buffer *buffer) {
+    assert(buffer);
+
+    buffer->size = 0;
+    buffer->position = 0;
+}
+
+void buffer_rewind(struct buffer *buffer) {
+    assert(buffer);
+
+    buffer->position = 0;
+}
+
+const unsigned char *buffer_get_data(const struct buffer *buffer) {
+    assert(buffer);
+
+    return buffer->data;
+}
+
+size_t buffer_get_size(const struct buffer *buffer) {
+    assert(buffer);
+
+    return buffer->size;
+}
+
+size_t buffer_get_position(const struct buffer *buffer) {
+    assert(buffer);
+
+    return buffer->position;
+}
+
+void buffer_skip(struct buffer *buffer, size_t size) {
+    assert(buffer);
+
+    if (size > buffer->size - buffer->position) {
+        error("Corrupted state, %lu bytes missing\n", (unsigned long) (size - (buffer->size - buffer->position)));
+    }
+
+    buffer->position += size;
+}
+
+Uint32 buffer_get_checksum(const struct buffer *buffer, size_t start, size_t size) {
+    assert(buffer);
+    assert(start <= buffer->size && size <= buffer->size - start);
+
+    Uint32 crc = 0xffffffff;
+
+    // bit by bit, a save is checked in well under a millisecond without any table
+    for (size_t i = start; i < start + size; i++) {
+        crc ^= buffer->data[i];
+
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+        }
+    }
+
+    return crc ^ 0xffffffff;
+}
+
+static void reserve(struct buffer *buffer, size_t size) {
+    assert(buffer);
+
+    if (buffer->size + size <= buffer->capacity) {
+        return;
+    }
+
+    while (buffer->size + size > buffer->capacity) {
+        buffer->capacity *= 2;
+    }
+
+    buffer->data = realloc(buffer->data, buffer->capacity);
+
+    if (!buffer->data) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+}
+
+int buffer_write_file(struct buffer *buffer, FILE *file) {
+    assert(buffer);
+    assert(file);
+
+    long start = ftell(file);
+
+    if (start < 0 || fseek(file, 0, SEEK_END) != 0) {
+        return 0;
+    }
+
+    long end = ftell(file);
+
+    if (end < start || fseek(file, start, SEEK_SET) != 0) {
+        return 0;
+    }
+
+    size_t size = (size_t) (end - start);
+
+    reserve(buffer, size);
+
+    if (fread(buffer->data + buffer->size, 1, size, file) != size) {
+        return 0;
+    }
+
+    buffer->size += size;
+
+    return 1;
+}
+
+void buffer_write_bytes(struct buffer *buffer, const void *bytes, size_t size) {
+    assert(buffer);
+    assert(bytes || size == 0);
+
+    reserve(buffer, size);
+
+    memcpy(buffer->data + buffer->size, bytes, size);
+    buffer->size += size;
+}
+
+void buffer_set_bytes(struct buffer *buffer, size_t position, const void *bytes, size_t size) {
+    assert(buffer);
+    assert(bytes || size == 0);
+    assert(position <= buffer->size && size <= buffer->size - position);
+
+    memcpy(buffer->data + position, bytes, size);
+}
+
+void buffer_xor_bytes(struct buffer *buffer, size_t position, const void *bytes, size_t size) {
+    assert(buffer);
+    assert(bytes || size == 0);
+    assert(position <= buffer->size && size <= buffer->size - position);
+
+    const unsigned char *source = bytes;
+
+    for (size_t i = 0; i < size; i++) {
+        buffer->data[position + i] ^= source[i];
+    }
+}
+
+void buffer_resize(struct buffer *buffer, size_t size) {
+    assert(buffer);
+
+    if (size > buffer->size) {
+        reserve(buffer, size - buffer->size);
+        memset(buffer->data + buffer->size, 0, size - buffer->size);
+    }
+
+    buffer->size = size;
+
+    if (buffer->position > size) {
+        buffer->position = size;
+    }
+}
+
+void buffer_shift(struct buffer *buffer, size_t size) {
+    assert(buffer);
+    assert(size <= buffer->size);
+
+    memmove(buffer->data, buffer->data + size, buffer->size - size);
+    buffer->size -= size;
+    buffer->position = 0;
+}
+
+void buffer_write_varint(struct buffer *buffer, Uint32 value) {
+    assert(buffer);
+
+    unsigned char bytes[5];
+    size_t size = 0;
+
+    // seven bits per byte, the high bit tells that more bytes follow
+    while (value >= 0x80) {
+        bytes[size++] = (unsigned char) ((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+
+    bytes[size++] = (unsigned char) value;
+
+    buffer_write_bytes(buffer, bytes, size);
+}
+
+void buffer_write_int(struct buffer *buffer, int value) {
+    assert(buffer);
+
+    // zigzag: the small negative values stay as short as the small positive ones
+    buffer_write_varint(buffer, ((Uint32) value << 1) ^ (Uint32) (value < 0 ? -1 : 0));
+}
+
+void buffer_read_bytes(struct buffer *buffer, void *bytes, size_t size) {
+    assert(buffer);
+    assert(bytes || size == 0);
+
+    if (size > buffer->size - buffer->position) {
+        error("Corrupted state, %lu bytes missing\n", (unsigned long) (size - (buffer->size - buffer->position)));
+    }
+
+    memcpy(bytes, buffer->data + buffer->position, size);
+    buffer->position += size;
+}
+
+Uint32 buffer_read_varint(struct buffer *buffer) {
+    assert(buffer);
+
+    Uint32 value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        unsigned char byte;
+
+        buffer_read_bytes(buffer, &byte, 1);
+        value |= (Uint32) (byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+
+    error("Corrupted state, varint too long\n");
+
+    return 0;
+}
+
+int buffer_read_int(struct buffer *buffer) {
+    assert(buffer);
+
+    Uint32 value = buffer_read_varint(buffer);
+
+    return (int) (value >> 1) ^ -(int) (value & 1);
+}
@@ -0,0 +1,121 @@
+#include "../include/camera.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing the camera.
+ */
+struct camera {
+    int max_width; /**< Maximum number of visible columns */
+    int max_height; /**< Maximum number of visible rows */
+    double x; /**< First visible column, between two columns while the camera scrolls */
+    double y; /**< First visible row, between two rows while the camera scrolls */
+    int width; /**< Number of visible columns */
+    int height; /**< Number of visible rows */
+};
+
+struct camera *camera_new(int width, int height) {
+    assert(width > 0 && height > 0);
+
+    struct camera *camera = malloc(sizeof(struct camera));
+
+    if (!camera) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(camera, 0, sizeof(struct camera));
+
+    camera->max_width = width;
+    camera->max_height = height;
+    camera->width = width;
+    camera->height = height;
+
+    return camera;
+}
+
+void camera_free(struct camera *camera) {
+    assert(camera);
+    free(camera);
+}
+
+static double follow_axis(double target, int visible, int map_size) {
+    double first = target - visible / 2;
+
+    if (first > map_size - visible) {
+        first = map_size - visible;
+    }
+
+    if (first < 0) {
+        first = 0;
+    }
+
+    return first;
+}
+
+void camera_follow(struct camera *camera, int map_width, int map_height, double x, double y) {
+    assert(camera);
+
+    camera->width = map_width < camera->max_width ? map_width : camera->max_width;
+    camera->height = map_height < camera->max_height ? map_height : camera->max_height;
+    camera->x = follow_axis(x, camera->width, map_width);
+    camera->y = follow_axis(y, camera->height, map_height);
+}
+
+int camera_get_x(struct camera *camera) {
+    assert(camera);
+    return (int) camera->x;
+}
+
+int camera_get_y(struct camera *camera) {
+    assert(camera);
+    return (int) camera->y;
+}
+
+int camera_get_width(struct camera *camera) {
+    assert(camera);
+    return camera->width;
+}
+
+int camera_get_height(struct camera *camera) {
+    assert(camera);
+    return camera->height;
+}
+
+int camera_is_visible(struct camera *camera, int x, int y) {
+    assert(camera);
+
+    // the cells partly scrolled out of the view are visible
+    if (x >= (int) camera->x && x < camera->x + camera->width && y >= (int) camera->y && y < camera->y + camera->height) {
+        return 1;
+    }
+
+    return 0;
+}
+
+static int round_coordinate(double coordinate) {
+    return coordinate < 0 ? -(int) (0.5 - coordinate) : (int) (coordinate + 0.5);
+}
+
+int camera_get_scroll_x(struct camera *camera) {
+    assert(camera);
+    return round_coordinate((camera->x - (int) camera->x) * SIZE_BLOC);
+}
+
+int camera_get_scroll_y(struct camera *camera) {
+    assert(camera);
+    return round_coordinate((camera->y - (int) camera->y) * SIZE_BLOC);
+}
+
+int camera_project_x(struct camera *camera, double x) {
+    assert(camera);
+    return round_coordinate((x - (int) camera->x) * SIZE_BLOC);
+}
+
+int camera_project_y(struct camera *camera, double y) {
+    assert(camera);
+    return round_coordinate((y - (int) camera->y) * SIZE_BLOC);
+}
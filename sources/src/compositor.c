@@ -0,0 +1,287 @@
+#include "../include/compositor.h"
+#include "../include/blit.h"
+#include "../include/constant.h"
+#include "../include/misc.h"
+#include "../include/window.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing a thread drawing a band of the frame.
+ */
+struct compositor_worker {
+    struct compositor *compositor; /**< Compositor the thread belongs to */
+    int band; /**< Index of the band drawn by the thread */
+    SDL_Thread *thread; /**< The thread, NULL for the calling one */
+    SDL_sem *start; /**< Posted when a frame is ready to be drawn */
+};
+
+/**
+ * @brief Structure representing the compositor.
+ */
+struct compositor {
+    int num_threads; /**< Number of threads, the calling one included */
+    struct compositor_worker workers[MAX_COMPOSITOR_THREADS]; /**< The threads, the calling one first */
+    SDL_sem *done; /**< Posted by every thread when its band is drawn */
+    int quit; /**< Set to stop the threads */
+    SDL_Surface *window; /**< Window of the frame being drawn */
+    struct render_command *commands; /**< Commands of the frame being drawn */
+    int num_commands; /**< Number of commands of the frame being drawn */
+    Uint32 clear_color; /**< Color of the window before drawing the sprites */
+};
+
+static void draw_band(struct compositor *compositor, int band) {
+    assert(compositor);
+
+    SDL_Surface *window = compositor->window;
+    SDL_Rect area;
+    int top = window->h * band / compositor->num_threads;
+    int bottom = window->h * (band + 1) / compositor->num_threads;
+
+    area.x = 0;
+    area.y = (Sint16) top;
+    area.w = (Uint16) window->w;
+    area.h = (Uint16) (bottom - top);
+
+    blit_fill(window, &area, compositor->clear_color);
+
+    for (int i = 0; i < compositor->num_commands; i++) {
+        struct render_command *command = &compositor->commands[i];
+
+        if (command->y < bottom && command->y + command->sprite.rect.h > top) {
+            blit_sprite(window, &area, &command->sprite, command->x, command->y);
+        }
+    }
+}
+
+static int compositor_worker_run(void *data) {
+    struct compositor_worker *worker = data;
+    struct compositor *compositor = worker->compositor;
+
+    for (;;) {
+        SDL_SemWait(worker->start);
+
+        if (compositor->quit) {
+            return 0;
+        }
+
+        draw_band(compositor, worker->band);
+        SDL_SemPost(compositor->done);
+    }
+}
+
+struct compositor *compositor_new(int num_threads) {
+    assert(num_threads >= 1 && num_threads <= MAX_COMPOSITOR_THREADS);
+
+    struct compositor *compositor = malloc(sizeof(struct compositor));
+
+    if (!compositor) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(compositor, 0, sizeof(struct compositor));
+
+    compositor->num_threads = num_threads;
+    compositor->done = SDL_CreateSemaphore(0);
+
+    for (int i = 0; i < num_threads; i++) {
+        struct compositor_worker *worker = &compositor->workers[i];
+
+        worker->compositor = compositor;
+        worker->band = i;
+
+        // the calling thread draws the first band itself
+        if (i == 0) {
+            continue;
+        }
+
+        worker->start = SDL_CreateSemaphore(0);
+        worker->thread = SDL_CreateThread(compositor_worker_run, worker);
+
+        if (!worker->thread) {
+            error("Can't create compositor thread: %s\n", SDL_GetError());
+        }
+    }
+
+    return compositor;
+}
+
+void compositor_free(struct compositor *compositor) {
+    assert(compositor);
+
+    compositor->quit = 1;
+
+    for (int i = 1; i < compositor->num_threads; i++) {
+        SDL_SemPost(compositor->workers[i].start);
+    }
+
+    for (int i = 1; i < compositor->num_threads; i++) {
+        SDL_WaitThread(compositor->workers[i].thread, NULL);
+        SDL_DestroySemaphore(compositor->workers[i].start);
+    }
+
+    SDL_DestroySemaphore(compositor->done);
+    free(compositor);
+}
+
+static int is_frame_supported(struct render_command *commands, int num_commands, SDL_Surface *window) {
+    for (int i = 0; i < num_commands; i++) {
+        if (!blit_is_supported(commands[i].sprite.surface, window)) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void compositor_draw(struct compositor *compositor, struct render_queue *queue, SDL_Surface *window) {
+    assert(compositor);
+    assert(queue);
+    assert(window);
+
+    render_queue_sort(queue);
+
+    struct render_command *commands = render_queue_get_commands(queue);
+    int num_commands = render_queue_get_num_commands(queue);
+
+    if (!is_frame_supported(commands, num_commands, window)) {
+        window_clear(window);
+        render_queue_execute(queue, window);
+        return;
+    }
+
+    if (SDL_MUSTLOCK(window) && SDL_LockSurface(window) != 0) {
+        error("Can't lock window: %s\n", SDL_GetError());
+    }
+
+    compositor->window = window;
+    compositor->commands = commands;
+    compositor->num_commands = num_commands;
+    compositor->clear_color = SDL_MapRGB(window->format, 255, 255, 255);
+
+    for (int i = 1; i < compositor->num_threads; i++) {
+        SDL_SemPost(compositor->workers[i].start);
+    }
+
+    draw_band(compositor, 0);
+
+    for (int i = 1; i < compositor->num_threads; i++) {
+        SDL_SemWait(compositor->done);
+    }
+
+    if (SDL_MUSTLOCK(window)) {
+        SDL_UnlockSurface(window);
+    }
+}
+
+int compositor_get_num_threads(struct compositor *compositor) {
+    assert(compositor);
+    return compositor->num_threads;
+}
+
+static void push_benchmark_frame(struct render_queue *queue, struct sprites *sprites, SDL_Surface *window) {
+    assert(queue);
+    assert(sprites);
+    assert(window);
+
+    // a busy frame: scenery everywhere, with a box, a bonus or a monster over one cell in three
+    for (int y = 0; y + SIZE_BLOC <= window->h; y += SIZE_BLOC) {
+        for (int x = 0; x + SIZE_BLOC <= window->w; x += SIZE_BLOC) {
+            int cell = x / SIZE_BLOC + y / SIZE_BLOC;
+
+            render_queue_push(queue, sprites_get_scenery(sprites, cell % 2 ? SCENERY_TREE : SCENERY_STONE), x, y, LAYER_BACKGROUND);
+
+            if (cell % 3 == 0) {
+                render_queue_push(queue, sprites_get_box(sprites), x, y, LAYER_CELLS);
+            } else if (cell % 3 == 1) {
+                render_queue_push(queue, sprites_get_bonus(sprites, BONUS_LIFE), x, y, LAYER_CELLS);
+                render_queue_push(queue, sprites_get_monster(sprites, SOUTH), x, y, LAYER_ENTITIES);
+            }
+        }
+    }
+}
+
+static void copy_frame(SDL_Surface *window, Uint8 *frame) {
+    for (int y = 0; y < window->h; y++) {
+        memcpy(frame + y * window->w * 4, (Uint8 *) window->pixels + y * window->pitch, window->w * 4);
+    }
+}
+
+void compositor_benchmark(struct sprites *sprites, SDL_Surface *window, int num_frames) {
+    assert(sprites);
+    assert(window);
+    assert(num_frames > 0);
+
+    if (window->format->BytesPerPixel != 4) {
+        printf("Compositor benchmark: the window must have 32 bits per pixel\n");
+        return;
+    }
+
+    struct render_queue *queue = render_queue_new();
+    size_t frame_size = (size_t) window->w * window->h * 4;
+    Uint8 *reference = malloc(frame_size);
+    Uint8 *frame = malloc(frame_size);
+
+    if (!reference || !frame) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    push_benchmark_frame(queue, sprites, window);
+
+    printf("Compositor benchmark (%d frames of %dx%d, %d sprites)\n", num_frames, window->w, window->h, render_queue_get_num_commands(queue));
+
+    Uint32 serial_duration = 0;
+
+    for (int num_threads = 1; num_threads <= MAX_COMPOSITOR_THREADS; num_threads++) {
+        struct compositor *compositor = compositor_new(num_threads);
+        Uint32 start = SDL_GetTicks();
+
+        for (int n = 0; n < num_frames; n++) {
+            compositor_draw(compositor, queue, window);
+        }
+
+        Uint32 duration = SDL_GetTicks() - start;
+
+        compositor_free(compositor);
+
+        SDL_LockSurface(window);
+        copy_frame(window, num_threads == 1 ? reference : frame);
+        SDL_UnlockSurface(window);
+
+        if (num_threads == 1) {
+            serial_duration = duration;
+        }
+
+        int is_identical = num_threads == 1 || memcmp(reference, frame, frame_size) == 0;
+
+        printf("  %d thread%s: %5u ms (%6.1f frames/s, x%.2f)%s\n", num_threads, num_threads > 1 ? "s" : " ", duration, duration ? 1000.0 * num_frames / duration : 0.0, duration ? (double) serial_duration / duration : 0.0, is_identical ? "" : " DIFFERENT FRAME");
+    }
+
+    // the serial frame must also be the one drawn by SDL itself, window_display_sprite would use the kernels
+    struct render_command *commands = render_queue_get_commands(queue);
+
+    window_clear(window);
+    render_queue_sort(queue);
+
+    for (int i = 0; i < render_queue_get_num_commands(queue); i++) {
+        SDL_Rect place;
+
+        place.x = commands[i].x;
+        place.y = commands[i].y;
+
+        SDL_BlitSurface(commands[i].sprite.surface, &commands[i].sprite.rect, window, &place);
+    }
+
+    SDL_LockSurface(window);
+    copy_frame(window, frame);
+    SDL_UnlockSurface(window);
+
+    printf("  same frame as SDL_BlitSurface: %s\n", memcmp(reference, frame, frame_size) == 0 ? "yes" : "no");
+
+    free(frame);
+    free(reference);
+    render_queue_free(queue);
+}
@@ -3,6 +3,7 @@
 #include "../include/constant.h"
 #include <limits.h>
 #include <assert.h>
+#include <stdlib.h>
 
 #define VERTEX(i, j) ((i) + (j) * graph->width)
 
@@ -30,7 +31,7 @@ struct graph {
 static int is_obstacle(struct map *map, int x, int y) {
     assert(map);
 
-    if (!map_is_inside(map, x, y)) {
+    if (!map_is_inside(map, x, y) || map_is_exploding(map, x, y)) {
         return 1;
     }
 
@@ -259,9 +260,9 @@ void dijkstra_update_monsters(struct map *map, struct player *player) {
 
         if (map_can_monster_move(map, player, current, next_dir)) {
             if (map_will_monster_meet_player(current, player, next_dir)) {
-                map_monster_meeting_player(current, player, next_dir);
+                map_monster_meeting_player(map, current, player, next_dir);
             } else {
-                monster_node_move(current, next_dir);
+                map_move_monster(map, current, next_dir);
             }
         }
 
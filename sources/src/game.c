@@ -1,26 +1,98 @@
 #include "../include/game.h"
+#include "../include/snapshot.h"
+#include "../include/input_ring.h"
+#include "../include/replay.h"
+#include "../include/autosave.h"
+#include "../include/history.h"
+#include "../include/timer.h"
 #include "../include/random.h"
 #include "../include/dijkstra.h"
+#include "../include/misc.h"
 #include "../include/constant.h"
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
+/**
+ * @brief First bytes of a save file.
+ */
+#define SAVE_MAGIC "BOMBSAVE"
+
+/**
+ * @brief Number of bytes of SAVE_MAGIC.
+ */
+#define SAVE_MAGIC_SIZE 8
+
+/**
+ * @brief Version of the save format, written after SAVE_MAGIC.
+ */
+#define SAVE_VERSION 5
+
+/**
+ * @brief Tags of the sections of a saved state, each one followed by the length of its payload.
+ */
+enum section_tag {
+    SECTION_GAME = 1, /**< Tick, current level, pause, pseudo-random numbers and number of levels */
+    SECTION_PLAYER = 2, /**< The player */
+    SECTION_LEVEL = 3, /**< Index of a level followed by its map */
+    SECTION_LEVEL_CHANGES = 4 /**< Index of a level followed by its changes since the previous save */
+};
+
+/**
+ * @brief Structure representing the fields of the game in a checkpoint, followed by its player and its current map.
+ */
+struct checkpoint {
+    Uint32 tick; /**< Number of game ticks since the start of the game */
+    int current_level; /**< Current level */
+    int is_paused; /**< Is the game paused ? */
+    Uint32 random_state; /**< State of the pseudo-random numbers */
+    long clock_origin; /**< Clock of the timers less the time of the ticks played, the same for every tick of a level */
+    Uint32 num_level_changes; /**< Number of level changes of the game, a checkpoint is only restored on the same level */
+};
+
 /**
  * @struct game
  * @brief Structure representing the game.
  */
 struct game {
-    struct sprites *sprites; /**< Sprites of the game */
-    SDL_Surface *window; /**< The window containing the game */
+    const struct backend *backends[MAX_BACKENDS]; /**< Backends displaying the game and giving its commands */
+    void *backend_data[MAX_BACKENDS]; /**< State of each backend */
+    int num_backends; /**< Number of backends */
     struct map **list_maps; /**< List of game maps */
     int num_levels; /**< Number of game maps */
     int current_level; /**< Current level */
     struct player *player; /**< Player of the game */
     int is_paused; /**< Is the game paused ? */
+    Uint32 tick; /**< Number of game ticks since the start of the game */
+    struct replay *replay; /**< Replay recording or playing back the inputs, NULL if none */
+    struct buffer *keyframe; /**< State of the game at the keyframes of the replay, NULL without replay */
+    struct autosave *autosave; /**< Thread writing the autosaves, NULL if none */
+    int is_saved; /**< Was the game saved on purpose ? Its autosave is removed otherwise */
+    int num_saved_changes; /**< Number of changes appended to the autosave since it was last written whole */
+    Uint32 num_level_changes; /**< Number of times another level was played or the levels were restored */
+    struct history *history; /**< Checkpoints of the last ticks of the current level to rewind the game, NULL if none */
+    struct buffer *history_state; /**< Checkpoint of the latest tick, added to the history */
+    struct input_ring *applied_inputs; /**< Inputs applied by the game ticks, waiting for a frame showing them */
+    Uint32 num_applied_inputs; /**< Number of inputs pushed to applied_inputs, written by the thread of the game */
+    Uint32 num_presented_inputs; /**< Number of inputs popped from applied_inputs, written by the thread of the display */
+    struct latency_histogram *apply_latency; /**< Latencies from the inputs to the game ticks applying them */
+    struct latency_histogram *present_latency; /**< Latencies from the inputs to the frames showing them */
+    int is_reporting_latency; /**< Are the latencies printed on stderr once the game is over ? */
 };
 
-struct game *game_new(void) {
+static void init_input_latency(struct game *game) {
+    assert(game);
+
+    game->applied_inputs = input_ring_new();
+    game->num_applied_inputs = 0;
+    game->num_presented_inputs = 0;
+    game->apply_latency = latency_histogram_new();
+    game->present_latency = latency_histogram_new();
+    game->is_reporting_latency = 0;
+}
+
+struct game *game_new(const struct backend *backend, const char *argument) {
+    assert(backend);
 
     struct game *game = malloc(sizeof(struct game));
 
@@ -50,7 +122,16 @@ struct game *game_new(void) {
 
     game->player = player_new(x_player, y_player, NUM_BOMBS_MAX);
     game->is_paused = 0;
-    game->sprites = sprites_new();
+    game->tick = 0;
+    game->replay = NULL;
+    game->keyframe = NULL;
+    game->autosave = NULL;
+    game->is_saved = 0;
+    game->num_saved_changes = 0;
+    game->history = NULL;
+    game->history_state = NULL;
+
+    init_input_latency(game);
     game->list_maps = malloc(game->num_levels * sizeof(struct map *));
 
     if (!game->list_maps) {
@@ -65,16 +146,78 @@ struct game *game_new(void) {
         game->list_maps[i] = map_new(map_filename);
     }
 
-    game->window = window_create(SIZE_BLOC * map_get_width(game_get_current_map(game)), SIZE_BLOC * map_get_height(game_get_current_map(game)) + BANNER_HEIGHT + LINE_HEIGHT);
+    game_add_backend(game, backend, argument);
 
     return game;
 }
 
+static Uint32 hash_int(Uint32 hash, int value) {
+    // FNV-1a over the bytes of the value, the same on every platform
+    for (int i = 0; i < 4; i++) {
+        hash ^= (Uint32) (value >> (8 * i)) & 0xff;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static Uint32 hash_state(struct game *game) {
+    assert(game);
+
+    struct player *player = game->player;
+    Uint32 hash = 2166136261u;
+
+    hash = hash_int(hash, game->current_level);
+    hash = hash_int(hash, player_get_x(player));
+    hash = hash_int(hash, player_get_y(player));
+    hash = hash_int(hash, player_get_num_lives(player));
+    hash = hash_int(hash, player_get_num_bomb(player));
+    hash = hash_int(hash, player_get_range_bombs(player));
+    hash = hash_int(hash, player_get_num_keys(player));
+
+    for (int i = 0; i < game->num_levels; i++) {
+        struct map *map = game->list_maps[i];
+        unsigned char *grid = map_get_grid(map);
+        int num_cells = map_get_width(map) * map_get_height(map);
+
+        for (int j = 0; j < num_cells; j++) {
+            hash = hash_int(hash, grid[j]);
+        }
+
+        for (struct monster_node *monster = map_get_monster_head(map); monster != NULL; monster = monster_node_get_next(monster)) {
+            hash = hash_int(hash, monster_node_get_x(monster));
+            hash = hash_int(hash, monster_node_get_y(monster));
+        }
+    }
+
+    return hash;
+}
+
 void game_free(struct game *game) {
     assert(game);
     assert(game->list_maps);
     assert(game->player);
 
+    // the final state is written or checked before it is freed
+    if (game->replay) {
+        replay_free(game->replay, game->tick, hash_state(game));
+        buffer_free(game->keyframe);
+    }
+
+    // a game quit or over starts again from the beginning, only a crash leaves its autosave behind
+    if (game->autosave) {
+        if (!game->is_saved) {
+            autosave_discard(game->autosave);
+        }
+
+        autosave_free(game->autosave);
+    }
+
+    if (game->history) {
+        history_free(game->history);
+        buffer_free(game->history_state);
+    }
+
     player_free(game->player);
 
     for (int i = 0; i < game->num_levels; i++) {
@@ -82,26 +225,363 @@ void game_free(struct game *game) {
     }
 
     free(game->list_maps);
-    sprites_free(game->sprites);
-    SDL_FreeSurface(game->window);
+
+    for (int i = 0; i < game->num_backends; i++) {
+        game->backends[i]->close(game->backend_data[i]);
+    }
+
+    if (game->is_reporting_latency && latency_histogram_get_count(game->apply_latency) > 0) {
+        latency_histogram_print(game->apply_latency, "Input to apply");
+        latency_histogram_print(game->present_latency, "Input to present");
+
+        if (latency_histogram_get_percentile(game->present_latency, 99) > INPUT_LATENCY_BUDGET * 1000) {
+            fprintf(stderr, "Input to present: the 99th percentile is over the budget of %d ms\n", INPUT_LATENCY_BUDGET);
+        }
+    }
+
+    input_ring_free(game->applied_inputs);
+    latency_histogram_free(game->apply_latency);
+    latency_histogram_free(game->present_latency);
     free(game);
 }
 
+static void write_section(struct buffer *buffer, enum section_tag tag, struct buffer *section) {
+    assert(buffer);
+    assert(section);
+
+    // the length lets a reader skip the sections it doesn't know
+    buffer_write_varint(buffer, tag);
+    buffer_write_varint(buffer, (Uint32) buffer_get_size(section));
+    buffer_write_bytes(buffer, buffer_get_data(section), buffer_get_size(section));
+
+    buffer_clear(section);
+}
+
+static void write_state(struct game *game, struct buffer *buffer, int only_changes) {
+    assert(game);
+    assert(buffer);
+
+    struct buffer *section = buffer_new();
+
+    // the clock comes before the levels, their timers are read relative to it
+    buffer_write_varint(section, game->tick);
+    buffer_write_varint(section, (Uint32) game->current_level);
+    buffer_write_varint(section, (Uint32) game->is_paused);
+    buffer_write_varint(section, random_get_state());
+    buffer_write_varint(section, (Uint32) game->num_levels);
+    buffer_write_varint(section, (Uint32) timer_get_clock());
+    write_section(buffer, SECTION_GAME, section);
+
+    player_serialize(game->player, section);
+    write_section(buffer, SECTION_PLAYER, section);
+
+    for (int i = 0; i < game->num_levels; i++) {
+        if (!only_changes) {
+            buffer_write_varint(section, (Uint32) i);
+            map_serialize(game->list_maps[i], section);
+            write_section(buffer, SECTION_LEVEL, section);
+        } else if (map_has_changes(game->list_maps[i])) {
+            buffer_write_varint(section, (Uint32) i);
+            map_serialize_changes(game->list_maps[i], section);
+            write_section(buffer, SECTION_LEVEL_CHANGES, section);
+        }
+    }
+
+    buffer_free(section);
+}
+
+void game_serialize(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    write_state(game, buffer, 0);
+}
+
+static int read_level_index(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    int level = (int) buffer_read_varint(buffer);
+
+    if (!game->list_maps || level < 0 || level >= game->num_levels) {
+        error("Corrupted state, section of level %d\n", level);
+    }
+
+    return level;
+}
+
+static void read_state(struct game *game, struct buffer *buffer, size_t end) {
+    assert(game);
+    assert(buffer);
+    assert(end <= buffer_get_size(buffer));
+
+    while (buffer_get_position(buffer) < end) {
+        Uint32 tag = buffer_read_varint(buffer);
+        size_t size = buffer_read_varint(buffer);
+        size_t section_end = buffer_get_position(buffer) + size;
+
+        if (section_end > end) {
+            error("Corrupted state, section %u of %lu bytes past the end\n", tag, (unsigned long) size);
+        }
+
+        switch (tag) {
+            case SECTION_GAME: {
+                game->tick = buffer_read_varint(buffer);
+                game->current_level = (int) buffer_read_varint(buffer);
+                game->is_paused = (int) buffer_read_varint(buffer);
+                random_set_seed(buffer_read_varint(buffer));
+
+                int num_levels = (int) buffer_read_varint(buffer);
+
+                if (!game->list_maps) {
+                    // each level takes at least a byte, a corrupted count can't allocate much
+                    if (num_levels <= 0 || (size_t) num_levels > end) {
+                        error("Corrupted state, %d levels\n", num_levels);
+                    }
+
+                    game->num_levels = num_levels;
+                    game->list_maps = calloc(num_levels, sizeof(struct map *));
+
+                    if (!game->list_maps) {
+                        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+                        exit(EXIT_FAILURE);
+                    }
+                } else if (num_levels != game->num_levels) {
+                    error("The state of the game was saved on other levels\n");
+                }
+
+                timer_set_clock(buffer_read_varint(buffer));
+                break;
+            }
+
+            case SECTION_PLAYER:
+                if (game->player) {
+                    player_free(game->player);
+                }
+
+                game->player = player_deserialize(buffer);
+                break;
+
+            case SECTION_LEVEL: {
+                int level = read_level_index(game, buffer);
+
+                if (game->list_maps[level]) {
+                    map_free(game->list_maps[level]);
+                }
+
+                game->list_maps[level] = map_deserialize(buffer);
+                break;
+            }
+
+            case SECTION_LEVEL_CHANGES: {
+                int level = read_level_index(game, buffer);
+
+                if (!game->list_maps[level]) {
+                    error("Corrupted state, changes of level %d before the level\n", level);
+                }
+
+                map_deserialize_changes(game->list_maps[level], buffer);
+                break;
+            }
+
+            default:
+                // a section of a later version, skipped as a whole
+                break;
+        }
+
+        if (buffer_get_position(buffer) > section_end) {
+            error("Corrupted state, section %u longer than its %lu bytes\n", tag, (unsigned long) size);
+        }
+
+        buffer_skip(buffer, section_end - buffer_get_position(buffer));
+    }
+}
+
+static void check_state(struct game *game) {
+    assert(game);
+
+    if (!game->list_maps || !game->player || game->current_level < 0 || game->current_level >= game->num_levels) {
+        error("Corrupted state, the game or its player is missing\n");
+    }
+
+    for (int i = 0; i < game->num_levels; i++) {
+        if (!game->list_maps[i]) {
+            error("Corrupted state, level %d is missing\n", i);
+        }
+    }
+}
+
+void game_restore(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(game->list_maps);
+    assert(buffer);
+
+    read_state(game, buffer, buffer_get_size(buffer));
+    check_state(game);
+
+    game->num_level_changes++;
+
+    if (game->history) {
+        history_clear(game->history);
+    }
+}
+
+void game_checkpoint(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    struct checkpoint checkpoint;
+
+    // the padding is written too, the history diffs it against the previous checkpoint
+    memset(&checkpoint, 0, sizeof(struct checkpoint));
+
+    checkpoint.tick = game->tick;
+    checkpoint.current_level = game->current_level;
+    checkpoint.is_paused = game->is_paused;
+    checkpoint.random_state = random_get_state();
+    checkpoint.clock_origin = timer_get_clock() - (long) game->tick * (1000 / DEFAULT_GAME_FPS);
+    checkpoint.num_level_changes = game->num_level_changes;
+
+    // the other levels don't change while the current one is played, a tick where nothing else moves only changes the tick
+    buffer_write_bytes(buffer, &checkpoint, sizeof(struct checkpoint));
+    player_checkpoint(game->player, buffer);
+    map_checkpoint(game->list_maps[game->current_level], buffer);
+}
+
+int game_rollback(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    struct checkpoint checkpoint;
+
+    buffer_rewind(buffer);
+    buffer_read_bytes(buffer, &checkpoint, sizeof(struct checkpoint));
+
+    if (checkpoint.num_level_changes != game->num_level_changes) {
+        return 0;
+    }
+
+    game->tick = checkpoint.tick;
+    game->is_paused = checkpoint.is_paused;
+    random_set_seed(checkpoint.random_state);
+    timer_set_clock(checkpoint.clock_origin + (long) checkpoint.tick * (1000 / DEFAULT_GAME_FPS));
+
+    player_rollback(game->player, buffer);
+    map_rollback(game->list_maps[game->current_level], buffer);
+
+    return 1;
+}
+
+static void encode_uint32(unsigned char *bytes, Uint32 value) {
+    assert(bytes);
+
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = (unsigned char) (value >> (8 * i));
+    }
+}
+
+static Uint32 get_uint32(struct buffer *buffer, size_t position) {
+    assert(buffer);
+    assert(position + 4 <= buffer_get_size(buffer));
+
+    const unsigned char *bytes = buffer_get_data(buffer) + position;
+    Uint32 value = 0;
+
+    for (int i = 0; i < 4; i++) {
+        value |= (Uint32) bytes[i] << (8 * i);
+    }
+
+    return value;
+}
+
+static void write_record(struct game *game, struct buffer *buffer, int only_changes) {
+    assert(game);
+    assert(buffer);
+
+    size_t size_position = buffer_get_size(buffer);
+
+    unsigned char bytes[4] = {0};
+
+    // the size is known once the state is written, it is patched in place
+    buffer_write_bytes(buffer, bytes, 4);
+    write_state(game, buffer, only_changes);
+
+    size_t start = size_position + 4;
+    size_t size = buffer_get_size(buffer) - start;
+
+    encode_uint32(bytes, (Uint32) size);
+    buffer_set_bytes(buffer, size_position, bytes, 4);
+
+    encode_uint32(bytes, buffer_get_checksum(buffer, start, size));
+    buffer_write_bytes(buffer, bytes, 4);
+
+    // the next changes start from this save
+    for (int i = 0; i < game->num_levels; i++) {
+        map_clear_changes(game->list_maps[i]);
+    }
+}
+
+static int read_record(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    size_t position = buffer_get_position(buffer);
+    size_t remaining = buffer_get_size(buffer) - position;
+
+    // a record cut or damaged by a crash while it was appended is left aside
+    if (remaining < 8) {
+        return 0;
+    }
+
+    size_t size = get_uint32(buffer, position);
+
+    if (size > remaining - 8 || get_uint32(buffer, position + 4 + size) != buffer_get_checksum(buffer, position + 4, size)) {
+        return 0;
+    }
+
+    buffer_skip(buffer, 4);
+    read_state(game, buffer, position + 4 + size);
+    buffer_skip(buffer, 4);
+
+    return 1;
+}
+
+void game_save(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    buffer_write_bytes(buffer, SAVE_MAGIC, SAVE_MAGIC_SIZE);
+    buffer_write_varint(buffer, SAVE_VERSION);
+    write_record(game, buffer, 0);
+}
+
+void game_save_changes(struct game *game, struct buffer *buffer) {
+    assert(game);
+    assert(buffer);
+
+    write_record(game, buffer, 1);
+}
+
 void game_write(struct game *game, FILE *file) {
     assert(game);
     assert(file);
 
-    fwrite(game, sizeof(struct game), 1, file);
+    // the whole save is built in memory, then written at once
+    struct buffer *buffer = buffer_new();
 
-    player_write(game->player, file);
+    game_save(game, buffer);
 
-    for (int i = 0; i < game->num_levels; i++) {
-        map_write(game->list_maps[i], file);
+    if (fwrite(buffer_get_data(buffer), 1, buffer_get_size(buffer), file) != buffer_get_size(buffer)) {
+        perror("fwrite save");
+        exit(EXIT_FAILURE);
     }
+
+    buffer_free(buffer);
 }
 
-struct game *game_read(FILE *file) {
+struct game *game_read(FILE *file, const struct backend *backend, const char *argument) {
     assert(file);
+    assert(backend);
 
     struct game *game = malloc(sizeof(struct game));
 
@@ -110,27 +590,79 @@ struct game *game_read(FILE *file) {
         exit(EXIT_FAILURE);
     }
 
-    fread(game, sizeof(struct game), 1, file);
+    memset(game, 0, sizeof(struct game));
 
-    game->player = player_read(file);
+    struct buffer *buffer = buffer_new();
 
-    game->list_maps = malloc(game->num_levels * sizeof(struct map *));
+    if (!buffer_write_file(buffer, file)) {
+        error("Can't read the backup file\n");
+    }
 
-    if (!game->list_maps) {
-        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
-        exit(EXIT_FAILURE);
+    size_t size = buffer_get_size(buffer);
+
+    if (size < SAVE_MAGIC_SIZE || memcmp(buffer_get_data(buffer), SAVE_MAGIC, SAVE_MAGIC_SIZE) != 0) {
+        error("The backup file isn't a save of this game\n");
+    }
+
+    buffer_skip(buffer, SAVE_MAGIC_SIZE);
+
+    Uint32 version = buffer_read_varint(buffer);
+
+    if (version != SAVE_VERSION) {
+        error("The backup file has version %u, this game reads version %d\n", version, SAVE_VERSION);
+    }
+
+    // the whole save, then the changes appended to it
+    if (!read_record(game, buffer)) {
+        error("The backup file is corrupted, its checksum doesn't match\n");
+    }
+
+    // the changes are read up to the end of the file, or up to a damaged one
+    while (read_record(game, buffer)) {
     }
 
+    if (buffer_get_position(buffer) < size) {
+        fprintf(stderr, "Backup: the last %lu bytes are damaged, the changes saved before are kept\n", (unsigned long) (size - buffer_get_position(buffer)));
+    }
+
+    check_state(game);
+    buffer_free(buffer);
+
+    // the next changes start from the state read
     for (int i = 0; i < game->num_levels; i++) {
-        game->list_maps[i] = map_read(file);
+        map_clear_changes(game->list_maps[i]);
     }
 
-    game->sprites = sprites_new();
-    game->window = window_create(SIZE_BLOC * map_get_width(game_get_current_map(game)), SIZE_BLOC * map_get_height(game_get_current_map(game)) + BANNER_HEIGHT + LINE_HEIGHT);
+    // the latencies are measured again from the loading
+    init_input_latency(game);
+
+    // a replay starts from a new game
+    game->replay = NULL;
+    game->keyframe = NULL;
+    game->autosave = NULL;
+    game->is_saved = 0;
+    game->num_saved_changes = 0;
+    game->history = NULL;
+    game->history_state = NULL;
+
+    game_add_backend(game, backend, argument);
 
     return game;
 }
 
+void game_add_backend(struct game *game, const struct backend *backend, const char *argument) {
+    assert(game);
+    assert(backend);
+
+    if (game->num_backends == MAX_BACKENDS) {
+        error("Too many backends, at most %d\n", MAX_BACKENDS);
+    }
+
+    game->backends[game->num_backends] = backend;
+    game->backend_data[game->num_backends] = backend->open(game, argument);
+    game->num_backends++;
+}
+
 struct map *game_get_current_map(struct game *game) {
     assert(game);
     assert(game->list_maps);
@@ -160,240 +692,403 @@ int game_get_current_level(struct game *game) {
     return game->current_level;
 }
 
-static void display_banner(struct game *game) {
+void game_record(struct game *game, const char *filename) {
     assert(game);
+    assert(filename);
+    assert(!game->replay && game->tick == 0);
 
-    struct map *map = game_get_current_map(game);
-    struct player *player = game_get_player(game);
+    game->replay = replay_new_recording(filename, hash_state(game));
+    game->keyframe = buffer_new();
+}
+
+void game_replay(struct game *game, const char *filename) {
+    assert(game);
+    assert(filename);
+    assert(!game->replay && game->tick == 0);
 
-    int y = (map_get_height(map)) * SIZE_BLOC;
+    game->replay = replay_new_playback(filename, hash_state(game));
+    game->keyframe = buffer_new();
+}
 
-    for (int i = 0; i < map_get_width(map); i++) {
-        window_display_image(game->window, sprites_get_banner_line(game->sprites), i * SIZE_BLOC, y);
-    }
+void game_autosave(struct game *game, const char *filename) {
+    assert(game);
+    assert(filename);
+    assert(!game->autosave && !game->replay);
 
-    int white_bloc = 0.5 * SIZE_BLOC;
-    int x = 0;
+    game->autosave = autosave_new(filename);
+}
 
-    y = (map_get_height(map) * SIZE_BLOC) + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_number(game->sprites, game_get_current_level(game) + 1), x, y);
+void game_enable_rewind(struct game *game) {
+    assert(game);
+    assert(!game->history && !game->replay);
 
-    x = SIZE_BLOC;
-    y = (map_get_height(map)) * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_banner_vertical_line(game->sprites), x, y);
+    game->history = history_new(REWIND_TICKS);
+    game->history_state = buffer_new();
+}
 
-    x = white_bloc + SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_banner_life(game->sprites), x, y);
+void game_report_latency(struct game *game) {
+    assert(game);
+    game->is_reporting_latency = 1;
+}
 
-    x = white_bloc + 2 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_number(game->sprites, player_get_num_lives(player)), x, y);
+int game_seek(struct game *game, Uint32 tick) {
+    assert(game);
+    assert(game->replay && replay_is_playback(game->replay));
 
-    x = 2 * white_bloc + 3 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_banner_bomb(game->sprites), x, y);
+    Uint64 start = get_monotonic_time();
+    Uint32 keyframe_tick = replay_seek(game->replay, tick, game->keyframe);
 
-    x = 2 * white_bloc + 4 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_number(game->sprites, player_get_num_bomb(game_get_player(game))), x, y);
+    game_restore(game, game->keyframe);
 
-    x = 3 * white_bloc + 5 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_banner_range(game->sprites), x, y);
+    // the ticks after the keyframe are played again, without being displayed
+    int done = 0;
 
-    x = 3 * white_bloc + 6 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_number(game->sprites, player_get_range_bombs(player)), x, y);
+    while (!done && game->tick < tick) {
+        done = game_update(game);
+    }
 
-    x = 4 * white_bloc + 7 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_key(game->sprites), x, y);
+    fprintf(stderr, "Seek: tick %u from the keyframe of tick %u in %.1f ms\n", game->tick, keyframe_tick, (get_monotonic_time() - start) / 1000.0);
 
-    x = 4 * white_bloc + 8 * SIZE_BLOC + LINE_HEIGHT;
-    window_display_image(game->window, sprites_get_number(game->sprites, player_get_num_keys(player)), x, y);
+    return done;
 }
 
-void game_display(struct game *game) {
+Uint32 game_get_num_applied_inputs(struct game *game) {
     assert(game);
 
-    window_clear(game->window);
+    return game->num_applied_inputs;
+}
 
-    map_display(game_get_current_map(game), game->window, game->sprites);
-    display_banner(game);
-    player_display(game_get_player(game), game->window, game->sprites);
+const struct latency_histogram *game_get_apply_latency(struct game *game) {
+    assert(game);
 
-    window_refresh(game->window);
+    return game->apply_latency;
+}
+
+const struct latency_histogram *game_get_present_latency(struct game *game) {
+    assert(game);
+
+    return game->present_latency;
+}
+
+void game_display(struct game *game, const struct snapshot *snapshot, double alpha) {
+    assert(game);
+    assert(snapshot);
+
+    for (int i = 0; i < game->num_backends; i++) {
+        game->backends[i]->display(game->backend_data[i], snapshot, alpha);
+    }
+
+    // the inputs applied up to the snapshot are on screen now, including those of the snapshots never displayed
+    Uint64 now = get_monotonic_time();
+    struct input_event input;
+
+    while (game->num_presented_inputs != snapshot->num_inputs && input_ring_pop(game->applied_inputs, &input)) {
+        latency_histogram_add(game->present_latency, now - input.time);
+        game->num_presented_inputs++;
+    }
+}
+
+void game_pump(struct game *game) {
+    assert(game);
+
+    for (int i = 0; i < game->num_backends; i++) {
+        game->backends[i]->pump(game->backend_data[i]);
+    }
 }
 
 static void change_current_level(struct game *game, int level) {
     assert(game);
 
     game_set_current_level(game, level);
+    game->num_level_changes++;
+
+    // the history only rewinds the current level
+    if (game->history) {
+        history_clear(game->history);
+    }
 
     player_set_num_bombs(game_get_player(game), NUM_BOMBS_MAX);
 
-    game->window = window_create(SIZE_BLOC * map_get_width(game_get_current_map(game)), SIZE_BLOC * map_get_height(game_get_current_map(game)) + BANNER_HEIGHT + LINE_HEIGHT);
+    // nothing slides across levels
+    player_save_position(game_get_player(game));
+    map_save_positions(game_get_current_map(game));
+}
+
+void game_soak_levels(struct game *game, int num_transitions) {
+    assert(game);
+    assert(num_transitions > 0);
+
+    struct snapshot *snapshot = snapshot_new();
+
+    // the first display of each level builds its background, which is then kept
+    for (int i = 0; i < game->num_levels; i++) {
+        change_current_level(game, (game->current_level + 1) % game->num_levels);
+        snapshot_capture(snapshot, game);
+        game_display(game, snapshot, 1);
+    }
+
+    size_t start_memory = get_resident_memory();
+    Uint32 total_duration = 0;
+    Uint32 batch_duration = 0;
+    Uint32 max_duration = 0;
+    int batch_size = 0;
+
+    for (int i = 1; i <= num_transitions; i++) {
+        Uint32 start = SDL_GetTicks();
+
+        change_current_level(game, (game->current_level + 1) % game->num_levels);
+        snapshot_capture(snapshot, game);
+        game_display(game, snapshot, 1);
+
+        Uint32 duration = SDL_GetTicks() - start;
+
+        total_duration += duration;
+        batch_duration += duration;
+        batch_size++;
+
+        if (duration > max_duration) {
+            max_duration = duration;
+        }
+
+        if (i % 100 == 0 || i == num_transitions) {
+            printf("Soak: %5d transitions, %.3f ms per transition, %lu KiB resident\n", i, (double) batch_duration / batch_size, (unsigned long) (get_resident_memory() / 1024));
+            batch_duration = 0;
+            batch_size = 0;
+        }
+    }
+
+    printf("Soak: %d transitions in %u ms (max %u ms), resident memory %lu KiB -> %lu KiB\n", num_transitions, total_duration, max_duration, (unsigned long) (start_memory / 1024), (unsigned long) (get_resident_memory() / 1024));
+
+    snapshot_free(snapshot);
 }
 
 static void save_game(struct game *game) {
     assert(game);
 
-    FILE *file = fopen(BACKUP_FILE, "wb");
+    if (game->autosave) {
+        // the save waits for the autosave being written, then goes through the same thread
+        game_save(game, autosave_begin(game->autosave, 1));
+        autosave_commit(game->autosave, 0);
+        autosave_flush(game->autosave);
+
+        game->is_saved = 1;
+    } else {
+        FILE *file = fopen(BACKUP_FILE, "wb");
+
+        if (!file) {
+            perror("fopen save_game");
+            exit(EXIT_FAILURE);
+        }
 
-    if (file) {
         game_write(game, file);
 
         fclose(file);
-
-        printf("#########################################\n");
-        printf("  Current game saved in %s\n", BACKUP_FILE);
-        printf("#########################################\n");
-    } else {
-        perror("fopen save_game");
-        exit(EXIT_FAILURE);
     }
+
+    printf("#########################################\n");
+    printf("  Current game saved in %s\n", BACKUP_FILE);
+    printf("#########################################\n");
 }
 
-static int input_keyboard(struct game *game) {
+static int move_player(struct game *game, enum direction direction) {
     assert(game);
 
-    SDL_Event event = {0};
-    int has_moved = 0;
     struct player *player = game_get_player(game);
     struct map *map = game_get_current_map(game);
 
-    while (SDL_PollEvent(&event)) {
+    if (!map_move_player(map, player, direction)) {
+        return 0;
+    }
+
+    unsigned char cell = map_get_cell_value(map, player_get_x(player), player_get_y(player));
+
+    if ((cell & 0xf0) == CELL_DOOR) {
+        int level = (cell & 0x0e) / 2;
+        change_current_level(game, level);
 
-        if (game->is_paused) {
+    } else if (cell == (CELL_SCENERY | SCENERY_PRINCESS)) {
 
-            switch (event.type) {
+        printf("==========================================\n");
+        printf(" >>>>>>>>>>>>>  YOU WON!!!  <<<<<<<<<<<<<\n");
+        printf("==========================================\n");
 
-                case SDL_QUIT:
-                    return 1;
+        return 1;
+    }
 
-                case SDL_KEYDOWN: {
-                    switch (event.key.keysym.sym) {
+    return 0;
+}
 
-                        // case ctrl + s
-                        case SDLK_s:
-                            if (event.key.keysym.mod & KMOD_CTRL) {
-                                save_game(game);
-                                return 1;
-                            }
+static void open_door(struct game *game) {
+    assert(game);
 
-                            break;
+    struct player *player = game_get_player(game);
+    struct map *map = game_get_current_map(game);
 
-                        case SDLK_p:
-                            game->is_paused = !game->is_paused;
-                            break;
+    // if looking toward the door
+    int x_next_player = direction_get_x(player_get_direction(player), player_get_x(player), 1);
+    int y_next_player = direction_get_y(player_get_direction(player), player_get_y(player), 1);
 
-                        default:
-                            break;
-                    }
-                }
+    if (map_is_inside(map, x_next_player, y_next_player)) {
+        unsigned char type = map_get_cell_value(map, x_next_player, y_next_player);
 
-                default:
-                    break;
-            }
-        } else {
+        if (((type & 0xf1) == (CELL_DOOR | CLOSED)) && player_get_num_keys(player)) {
+            // opening the door
+            map_set_cell_value(map, x_next_player, y_next_player, type & 0xfe);
+            player_dec_num_keys(player);
+        }
+    }
+}
+
+static void record_history(struct game *game, struct history *history, struct buffer *state) {
+    assert(game);
+    assert(history);
+    assert(state);
+
+    buffer_clear(state);
+    game_checkpoint(game, state);
+    history_record(history, state);
+}
+
+static void step_history(struct game *game, int is_forward) {
+    assert(game);
+    assert(game->history);
+
+    for (int i = 0; i < REWIND_STEP_TICKS; i++) {
+        struct buffer *state = is_forward ? history_forward(game->history) : history_back(game->history);
+
+        if (!state) {
+            break;
+        }
 
-            switch (event.type) {
+        // a state of another level is stepped over again
+        if (!game_rollback(game, state)) {
+            if (is_forward) {
+                history_back(game->history);
+            } else {
+                history_forward(game->history);
+            }
 
-                case SDL_QUIT:
-                    return 1;
+            break;
+        }
+    }
 
-                case SDL_KEYDOWN: {
-                    switch (event.key.keysym.sym) {
+    // the game goes on from the state stepped to once it is resumed, the states after it are forgotten
+    game->is_paused = 1;
+}
 
-                        // case ctrl + s
-                        case SDLK_s:
-                            if (event.key.keysym.mod & KMOD_CTRL) {
-                                save_game(game);
-                                return 1;
-                            }
+static int apply_action(struct game *game, enum action action) {
+    assert(game);
 
-                            break;
+    switch (action) {
 
-                        case SDLK_UP:
+        case ACTION_QUIT:
+            return 1;
 
-                            if (map_move_player(map, player, NORTH)) {
-                                has_moved = 1;
-                            }
+        case ACTION_SAVE:
+            save_game(game);
+            return 1;
 
-                            break;
+        case ACTION_PAUSE:
+            game->is_paused = !game->is_paused;
+            return 0;
 
-                        case SDLK_DOWN:
+        // without a history, as in the replays, the game isn't rewound
+        case ACTION_BACK:
+        case ACTION_FORWARD:
+            if (game->history) {
+                step_history(game, action == ACTION_FORWARD);
+            }
 
-                            if (map_move_player(map, player, SOUTH)) {
-                                has_moved = 1;
-                            }
+            return 0;
 
-                            break;
+        default:
+            break;
+    }
 
-                        case SDLK_RIGHT:
+    if (game->is_paused) {
+        return 0;
+    }
 
-                            if (map_move_player(map, player, EAST)) {
-                                has_moved = 1;
-                            }
+    switch (action) {
 
-                            break;
+        case ACTION_NORTH:
+            return move_player(game, NORTH);
 
-                        case SDLK_LEFT:
+        case ACTION_SOUTH:
+            return move_player(game, SOUTH);
 
-                            if (map_move_player(map, player, WEST)) {
-                                has_moved = 1;
-                            }
+        case ACTION_EAST:
+            return move_player(game, EAST);
 
-                            break;
+        case ACTION_WEST:
+            return move_player(game, WEST);
 
-                        case SDLK_SPACE:
-                            map_set_bomb(map, player);
-                            break;
+        case ACTION_BOMB:
+            map_set_bomb(game_get_current_map(game), game_get_player(game));
+            break;
 
-                        case SDLK_p:
-                            game->is_paused = !game->is_paused;
-                            break;
+        case ACTION_OPEN:
+            open_door(game);
+            break;
 
-                            // if pressing enter while looking toward the door
-                        case SDLK_RETURN: {
+        default:
+            break;
+    }
 
-                            int x_next_player = direction_get_x(player_get_direction(player), player_get_x(player), 1);
-                            int y_next_player = direction_get_y(player_get_direction(player), player_get_y(player), 1);
+    return 0;
+}
 
-                            if (map_is_inside(map, x_next_player, y_next_player)) {
-                                unsigned char type = map_get_cell_value(map, x_next_player, y_next_player);
+static int replay_actions(struct game *game) {
+    assert(game);
 
-                                if (((type & 0xf1) == (CELL_DOOR | CLOSED)) && player_get_num_keys(player)) {
-                                    // opening the door
-                                    map_set_cell_value(map, x_next_player, y_next_player, type & 0xfe);
-                                    player_dec_num_keys(player);
-                                }
-                            }
+    enum action action;
+    Uint64 time;
 
-                            break;
-                        }
+    // the backends are still drained, so that their queues don't fill up: only quitting stops the replay
+    for (int i = 0; i < game->num_backends; i++) {
+        while ((action = game->backends[i]->poll(game->backend_data[i], &time)) != ACTION_NONE) {
+            if (action == ACTION_QUIT) {
+                return 1;
+            }
+        }
+    }
 
-                        default:
-                            break;
-                    }
+    while ((action = replay_play(game->replay, game->tick)) != ACTION_NONE) {
+        if (action == ACTION_SAVE || apply_action(game, action)) {
+            return 1;
+        }
+    }
 
-                    if (has_moved) {
+    return replay_is_over(game->replay, game->tick);
+}
 
-                        unsigned char cell = map_get_cell_value(map, player_get_x(player), player_get_y(player));
+static int input_actions(struct game *game) {
+    assert(game);
 
-                        if ((cell & 0xf0) == CELL_DOOR) {
-                            int level = (cell & 0x0e) / 2;
-                            change_current_level(game, level);
+    if (game->replay && replay_is_playback(game->replay)) {
+        return replay_actions(game);
+    }
 
-                        } else if (cell == (CELL_SCENERY | SCENERY_PRINCESS)) {
+    struct input_event input;
+    Uint64 now = get_monotonic_time();
 
-                            printf("==========================================\n");
-                            printf(" >>>>>>>>>>>>>  YOU WON!!!  <<<<<<<<<<<<<\n");
-                            printf("==========================================\n");
+    // each backend gives all its commands for the tick before the next one
+    for (int i = 0; i < game->num_backends; i++) {
+        while ((input.action = game->backends[i]->poll(game->backend_data[i], &input.time)) != ACTION_NONE) {
+            if (game->replay) {
+                replay_record(game->replay, game->tick, input.action);
+            }
 
-                            return 1;
-                        }
-                    }
+            if (apply_action(game, input.action)) {
+                return 1;
+            }
 
-                    break;
-                }
+            // a backend reading its input right now is as late as the tick
+            latency_histogram_add(game->apply_latency, now > input.time ? now - input.time : 0);
 
-                default:
-                    break;
+            // without room, the input isn't counted: the display pops as many inputs as were pushed
+            if (input_ring_push(game->applied_inputs, &input)) {
+                game->num_applied_inputs++;
             }
         }
     }
@@ -401,6 +1096,21 @@ static int input_keyboard(struct game *game) {
     return 0;
 }
 
+static void update_level(struct game *game) {
+    assert(game);
+
+    struct map *map = game_get_current_map(game);
+    struct player *player = game_get_player(game);
+
+    map_update_bombs(map, player);
+
+    if (map_get_monsters_strategy(map) == DIJKSTRA_STRATEGY) {
+        dijkstra_update_monsters(map, player);
+    } else {
+        random_update_monsters(map, player);
+    }
+}
+
 int game_update(struct game *game) {
     assert(game);
 
@@ -412,17 +1122,48 @@ int game_update(struct game *game) {
 
     assert(player);
 
-    if (input_keyboard(game)) {
+    // the keyframes hold the state between two ticks
+    if (game->replay && !replay_is_playback(game->replay) && game->tick % REPLAY_KEYFRAME_INTERVAL == 0) {
+        buffer_clear(game->keyframe);
+        game_serialize(game, game->keyframe);
+        replay_record_keyframe(game->replay, game->tick, game->keyframe);
+    }
+
+    // the state is captured in memory here, the thread of the autosave writes it to the disk
+    if (game->autosave && game->tick > 0 && game->tick % AUTOSAVE_INTERVAL == 0) {
+        struct buffer *buffer = autosave_begin(game->autosave, 0);
+
+        // a disk slower than the interval skips an autosave rather than stalling the game, the changes wait
+        if (buffer) {
+            // from time to time, the changes appended are compacted into a whole save
+            int is_whole = !autosave_has_base(game->autosave) || game->num_saved_changes == AUTOSAVE_MAX_CHANGES;
+
+            if (is_whole) {
+                game_save(game, buffer);
+                game->num_saved_changes = 0;
+            } else {
+                game_save_changes(game, buffer);
+                game->num_saved_changes++;
+            }
+
+            autosave_commit(game->autosave, !is_whole);
+        }
+    }
+
+    // the timers only follow the game ticks, a replay goes through the same ticks at any pace
+    game->tick++;
+    timer_advance_clock(1000 / DEFAULT_GAME_FPS);
+
+    if (input_actions(game)) {
         return 1;
     }
 
     if (!game->is_paused) {
-        map_update_bombs(map, player);
+        update_level(game);
 
-        if (map_get_monsters_strategy(map) == DIJKSTRA_STRATEGY) {
-            dijkstra_update_monsters(map, player);
-        } else {
-            random_update_monsters(map, player);
+        // a paused game doesn't change, nor does the game stepped through its history
+        if (game->history) {
+            record_history(game, game->history, game->history_state);
         }
     }
 
@@ -436,3 +1177,75 @@ int game_update(struct game *game) {
 
     return 0;
 }
+
+void game_bench_checkpoints(struct game *game, int num_checkpoints) {
+    assert(game);
+    assert(num_checkpoints > 0);
+
+    struct buffer *buffer = buffer_new();
+    Uint32 hash = hash_state(game);
+
+    Uint64 start = get_monotonic_time();
+
+    for (int i = 0; i < num_checkpoints; i++) {
+        buffer_clear(buffer);
+        game_checkpoint(game, buffer);
+    }
+
+    Uint64 checkpoint_duration = get_monotonic_time() - start;
+
+    // the game moves on without the backends, a bomb is laid then each rollback brings the game back
+    struct history *history = history_new(CHECKPOINT_BENCH_TICKS);
+    struct buffer *state = buffer_new();
+    Uint64 record_duration = 0;
+
+    record_history(game, history, state);
+    apply_action(game, ACTION_BOMB);
+
+    for (int i = 0; i < CHECKPOINT_BENCH_TICKS; i++) {
+        game->tick++;
+        timer_advance_clock(1000 / DEFAULT_GAME_FPS);
+        update_level(game);
+
+        Uint64 record_start = get_monotonic_time();
+
+        record_history(game, history, state);
+        record_duration += get_monotonic_time() - record_start;
+    }
+
+    // the history steps back to the first tick then forward to the last one
+    Uint32 last_hash = hash_state(game);
+    int is_rewound = 1;
+    struct buffer *step;
+
+    while ((step = history_back(history)) != NULL) {
+        is_rewound = game_rollback(game, step) && is_rewound;
+    }
+
+    is_rewound = is_rewound && hash_state(game) == hash;
+
+    while ((step = history_forward(history)) != NULL) {
+        is_rewound = game_rollback(game, step) && is_rewound;
+    }
+
+    is_rewound = is_rewound && hash_state(game) == last_hash;
+
+    printf("History: %d ticks in %lu bytes, %.3f us to record a tick, %s states\n", CHECKPOINT_BENCH_TICKS, (unsigned long) history_get_size(history), (double) record_duration / CHECKPOINT_BENCH_TICKS, is_rewound ? "same" : "different");
+
+    history_free(history);
+    buffer_free(state);
+
+    start = get_monotonic_time();
+
+    int is_restored = 1;
+
+    for (int i = 0; i < num_checkpoints; i++) {
+        is_restored = game_rollback(game, buffer) && is_restored;
+    }
+
+    Uint64 rollback_duration = get_monotonic_time() - start;
+
+    printf("Checkpoint: %lu bytes, %.3f us to take, %.3f us to restore, %s state\n", (unsigned long) buffer_get_size(buffer), (double) checkpoint_duration / num_checkpoints, (double) rollback_duration / num_checkpoints, is_restored && hash_state(game) == hash ? "same" : "different");
+
+    buffer_free(buffer);
+}
@@ -0,0 +1,213 @@
+#include "../include/history.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Number of equal bytes ending a run of differences, fewer ones are kept in the run.
+ */
+#define HISTORY_MIN_GAP 4
+
+/**
+ * @brief Structure representing a history of states.
+ */
+struct history {
+    struct buffer *state; /**< Current state */
+    int has_state; /**< Was a state recorded ? */
+    struct buffer *steps; /**< Differences between each state and the previous one, the oldest first */
+    size_t *offsets; /**< Offset of each difference in steps, followed by the size of steps */
+    int num_steps; /**< Number of differences in steps */
+    int max_steps; /**< Number of differences steps can hold, a few more than asked for */
+    int cursor; /**< Number of differences leading from the oldest state to the current one */
+};
+
+struct history *history_new(int num_steps) {
+    assert(num_steps > 0);
+
+    struct history *history = malloc(sizeof(struct history));
+
+    if (!history) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(history, 0, sizeof(struct history));
+
+    // the oldest eighth is forgotten at once, the history keeps at least num_steps
+    history->max_steps = num_steps + num_steps / 8 + 1;
+    history->offsets = malloc((history->max_steps + 1) * sizeof(size_t));
+
+    if (!history->offsets) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    history->state = buffer_new();
+    history->steps = buffer_new();
+    history->offsets[0] = 0;
+
+    return history;
+}
+
+void history_free(struct history *history) {
+    assert(history);
+
+    buffer_free(history->state);
+    buffer_free(history->steps);
+    free(history->offsets);
+    free(history);
+}
+
+void history_clear(struct history *history) {
+    assert(history);
+
+    buffer_clear(history->state);
+    buffer_clear(history->steps);
+    history->has_state = 0;
+    history->num_steps = 0;
+    history->cursor = 0;
+}
+
+static unsigned char get_byte(const unsigned char *bytes, size_t size, size_t i) {
+    return i < size ? bytes[i] : 0;
+}
+
+static void write_difference(struct buffer *steps, const struct buffer *from, const struct buffer *to) {
+    assert(steps);
+    assert(from);
+    assert(to);
+
+    const unsigned char *from_bytes = buffer_get_data(from);
+    const unsigned char *to_bytes = buffer_get_data(to);
+    size_t from_size = buffer_get_size(from);
+    size_t to_size = buffer_get_size(to);
+    size_t size = from_size > to_size ? from_size : to_size;
+
+    buffer_write_varint(steps, (Uint32) from_size);
+    buffer_write_varint(steps, (Uint32) to_size);
+
+    // runs of the bytes xor'ed, the shorter state padded with zeros: the same run goes both ways
+    size_t end = 0;
+    size_t i = 0;
+
+    while (i < size) {
+        if (get_byte(from_bytes, from_size, i) == get_byte(to_bytes, to_size, i)) {
+            i++;
+            continue;
+        }
+
+        size_t start = i;
+        size_t gap = 0;
+
+        for (; i < size && gap < HISTORY_MIN_GAP; i++) {
+            gap = get_byte(from_bytes, from_size, i) == get_byte(to_bytes, to_size, i) ? gap + 1 : 0;
+        }
+
+        size_t run_end = i - gap;
+
+        buffer_write_varint(steps, (Uint32) (start - end));
+        buffer_write_varint(steps, (Uint32) (run_end - start));
+
+        for (size_t j = start; j < run_end; j++) {
+            unsigned char byte = get_byte(from_bytes, from_size, j) ^ get_byte(to_bytes, to_size, j);
+
+            buffer_write_bytes(steps, &byte, 1);
+        }
+
+        end = run_end;
+    }
+}
+
+static void apply_difference(struct history *history, int step, int is_forward) {
+    assert(history);
+    assert(step >= 0 && step < history->num_steps);
+
+    struct buffer *steps = history->steps;
+
+    buffer_rewind(steps);
+    buffer_skip(steps, history->offsets[step]);
+
+    size_t from_size = buffer_read_varint(steps);
+    size_t to_size = buffer_read_varint(steps);
+    size_t position = 0;
+
+    buffer_resize(history->state, from_size > to_size ? from_size : to_size);
+
+    while (buffer_get_position(steps) < history->offsets[step + 1]) {
+        position += buffer_read_varint(steps);
+
+        size_t length = buffer_read_varint(steps);
+
+        buffer_xor_bytes(history->state, position, buffer_get_data(steps) + buffer_get_position(steps), length);
+        buffer_skip(steps, length);
+        position += length;
+    }
+
+    buffer_resize(history->state, is_forward ? to_size : from_size);
+}
+
+void history_record(struct history *history, const struct buffer *state) {
+    assert(history);
+    assert(state);
+
+    if (history->has_state) {
+        // the states stepped back from are another future now
+        history->num_steps = history->cursor;
+        buffer_resize(history->steps, history->offsets[history->num_steps]);
+
+        if (history->num_steps == history->max_steps) {
+            int num_forgotten = history->max_steps / 8 + 1;
+            size_t forgotten_size = history->offsets[num_forgotten];
+
+            buffer_shift(history->steps, forgotten_size);
+
+            for (int i = 0; i <= history->num_steps - num_forgotten; i++) {
+                history->offsets[i] = history->offsets[i + num_forgotten] - forgotten_size;
+            }
+
+            history->num_steps -= num_forgotten;
+        }
+
+        write_difference(history->steps, history->state, state);
+
+        history->num_steps++;
+        history->offsets[history->num_steps] = buffer_get_size(history->steps);
+        history->cursor = history->num_steps;
+    }
+
+    buffer_clear(history->state);
+    buffer_write_bytes(history->state, buffer_get_data(state), buffer_get_size(state));
+    history->has_state = 1;
+}
+
+struct buffer *history_back(struct history *history) {
+    assert(history);
+
+    if (history->cursor == 0) {
+        return NULL;
+    }
+
+    history->cursor--;
+    apply_difference(history, history->cursor, 0);
+
+    return history->state;
+}
+
+struct buffer *history_forward(struct history *history) {
+    assert(history);
+
+    if (history->cursor == history->num_steps) {
+        return NULL;
+    }
+
+    apply_difference(history, history->cursor, 1);
+    history->cursor++;
+
+    return history->state;
+}
+
+size_t history_get_size(struct history *history) {
+    assert(history);
+
+    return buffer_get_size(history->steps);
+}
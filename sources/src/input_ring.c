@@ -0,0 +1,75 @@
+#include "../include/input_ring.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Number of events a ring can hold, far more than the keys pressed during a game tick. A power of two.
+ */
+#define INPUT_RING_SIZE 256
+
+/**
+ * @brief Structure representing a ring of input events, with a single thread on each side.
+ * The counters only grow, each one is written by a single thread: the ring holds head - tail events.
+ */
+struct input_ring {
+    unsigned int head; /**< Number of events pushed, written by the pushing thread */
+    struct input_event events[INPUT_RING_SIZE]; /**< Events of the ring, also keeping the counters apart */
+    unsigned int tail; /**< Number of events popped, written by the popping thread */
+};
+
+struct input_ring *input_ring_new(void) {
+    struct input_ring *ring = malloc(sizeof(struct input_ring));
+
+    if (!ring) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(ring, 0, sizeof(struct input_ring));
+
+    return ring;
+}
+
+void input_ring_free(struct input_ring *ring) {
+    assert(ring);
+
+    free(ring);
+}
+
+int input_ring_push(struct input_ring *ring, const struct input_event *event) {
+    assert(ring);
+    assert(event);
+    assert(event->action != ACTION_NONE);
+
+    unsigned int head = ring->head;
+
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == INPUT_RING_SIZE) {
+        return 0;
+    }
+
+    ring->events[head % INPUT_RING_SIZE] = *event;
+
+    // the event is written before the other thread sees it
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+int input_ring_pop(struct input_ring *ring, struct input_event *event) {
+    assert(ring);
+    assert(event);
+
+    unsigned int tail = ring->tail;
+
+    if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == tail) {
+        return 0;
+    }
+
+    *event = ring->events[tail % INPUT_RING_SIZE];
+
+    // the slot is read before the other thread writes it again
+    __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+
+    return 1;
+}
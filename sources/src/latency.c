@@ -0,0 +1,102 @@
+#include "../include/latency.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing a histogram of latencies.
+ */
+struct latency_histogram {
+    int buckets[LATENCY_NUM_BUCKETS]; /**< Number of latencies in each step of LATENCY_BUCKET, the last one counts all the longer ones */
+    int count; /**< Number of latencies */
+    Uint64 max; /**< Highest latency */
+};
+
+struct latency_histogram *latency_histogram_new(void) {
+    struct latency_histogram *histogram = malloc(sizeof(struct latency_histogram));
+
+    if (!histogram) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(histogram, 0, sizeof(struct latency_histogram));
+
+    return histogram;
+}
+
+void latency_histogram_free(struct latency_histogram *histogram) {
+    assert(histogram);
+
+    free(histogram);
+}
+
+void latency_histogram_add(struct latency_histogram *histogram, Uint64 latency) {
+    assert(histogram);
+
+    Uint64 bucket = latency / LATENCY_BUCKET;
+
+    histogram->buckets[bucket < LATENCY_NUM_BUCKETS ? bucket : LATENCY_NUM_BUCKETS - 1]++;
+    histogram->count++;
+
+    if (latency > histogram->max) {
+        histogram->max = latency;
+    }
+}
+
+int latency_histogram_get_count(const struct latency_histogram *histogram) {
+    assert(histogram);
+
+    return histogram->count;
+}
+
+Uint64 latency_histogram_get_percentile(const struct latency_histogram *histogram, double percentile) {
+    assert(histogram);
+    assert(percentile >= 0 && percentile <= 100);
+
+    if (histogram->count == 0) {
+        return 0;
+    }
+
+    // rank of the latency among the sorted ones, starting from 1
+    int rank = (int) (percentile * histogram->count / 100);
+
+    if (rank < histogram->count * percentile / 100) {
+        rank++;
+    }
+
+    if (rank < 1) {
+        rank = 1;
+    }
+
+    int num_latencies = 0;
+
+    for (int i = 0; i < LATENCY_NUM_BUCKETS - 1; i++) {
+        num_latencies += histogram->buckets[i];
+
+        if (num_latencies >= rank) {
+            Uint64 end = (Uint64) (i + 1) * LATENCY_BUCKET;
+
+            return end < histogram->max ? end : histogram->max;
+        }
+    }
+
+    return histogram->max;
+}
+
+Uint64 latency_histogram_get_max(const struct latency_histogram *histogram) {
+    assert(histogram);
+
+    return histogram->max;
+}
+
+void latency_histogram_print(const struct latency_histogram *histogram, const char *name) {
+    assert(histogram);
+    assert(name);
+
+    fprintf(stderr, "%s: %d inputs, p50 %.1f ms, p99 %.1f ms, max %.1f ms\n", name, histogram->count,
+            latency_histogram_get_percentile(histogram, 50) / 1000.0,
+            latency_histogram_get_percentile(histogram, 99) / 1000.0,
+            histogram->max / 1000.0);
+}
@@ -1,48 +1,228 @@
 #include "../include/game.h"
+#include "../include/simulation.h"
+#include "../include/random.h"
 #include "../include/misc.h"
 #include "../include/constant.h"
-#include "../include/timer.h"
+#include "../include/window.h"
+#include "../include/compositor.h"
+#include "../include/blit.h"
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 int main(int argc, char *argv[]) {
 
-    if (SDL_Init(SDL_INIT_EVERYTHING) == -1) {
+    const struct backend *backend = &sdl_backend;
+    const char *argument = NULL;
+    const struct backend *monitor = NULL;
+    const char *monitor_argument = NULL;
+    const char *record_file = NULL;
+    const char *replay_file = NULL;
+    Uint32 replay_tick = 0;
+    int is_headless = 0;
+
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+        backend = &null_backend;
+        argument = argc > 2 ? argv[2] : NULL;
+        is_headless = 1;
+    } else if (argc > 1 && strcmp(argv[1], "--terminal") == 0) {
+        backend = &terminal_backend;
+        argument = argc > 2 ? argv[2] : NULL;
+    } else if (argc > 1 && strcmp(argv[1], "--monitor") == 0) {
+        // the window is watched from a terminal too
+        monitor = &terminal_backend;
+        monitor_argument = argc > 2 ? argv[2] : NULL;
+    } else if (argc > 2 && strcmp(argv[1], "--tile-size") == 0) {
+        argument = argv[2];
+    } else if (argc > 2 && strcmp(argv[1], "--record") == 0) {
+        record_file = argv[2];
+    } else if (argc > 2 && strcmp(argv[1], "--replay") == 0) {
+        replay_file = argv[2];
+        replay_tick = argc > 3 ? (Uint32) strtoul(argv[3], NULL, 10) : 0;
+    } else if (argc > 2 && strcmp(argv[1], "--replay-fast") == 0) {
+        // the replay runs as fast as possible, without any window nor command
+        backend = &null_backend;
+        argument = "";
+        replay_file = argv[2];
+        replay_tick = argc > 3 ? (Uint32) strtoul(argv[3], NULL, 10) : 0;
+    }
+
+    if (SDL_Init(backend->subsystems | (monitor ? monitor->subsystems : 0)) == -1) {
         error("Can't init SDL:  %s\n", SDL_GetError());
         exit(EXIT_FAILURE);
     }
 
+    blit_init();
+
+    // a replay seeds the game again with the seed it records
+    random_set_seed((Uint32) time(NULL));
+
+    if (argc > 1 && strcmp(argv[1], "--bench-tiles") == 0) {
+        SDL_Surface *window = window_create(10 * SIZE_BLOC, 10 * SIZE_BLOC);
+        struct sprites *sprites = sprites_new();
+
+        blit_benchmark(sprites_get_scenery(sprites, SCENERY_STONE), sprites_get_player(sprites, SOUTH), window, 100000);
+
+        sprites_free(sprites);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-blit") == 0) {
+        SDL_Surface *window = window_create(10 * SIZE_BLOC, 10 * SIZE_BLOC);
+        struct sprites *sprites = sprites_new();
+
+        sprites_benchmark(sprites, window, 1000);
+
+        sprites_free(sprites);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-compositor") == 0) {
+        SDL_Surface *window = window_create(32 * SIZE_BLOC, 18 * SIZE_BLOC);
+        struct sprites *sprites = sprites_new();
+
+        compositor_benchmark(sprites, window, 200);
+
+        sprites_free(sprites);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bake-pack") == 0) {
+        window_create(10 * SIZE_BLOC, 10 * SIZE_BLOC);
+        struct sprites *sprites = sprites_new();
+
+        sprites_bake_pack(sprites);
+
+        sprites_free(sprites);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--bench-startup") == 0) {
+        Uint32 start = SDL_GetTicks();
+
+        // the backup is read as a launch would, but kept
+        FILE *backup_file = fopen(BACKUP_FILE, "rb");
+        struct game *game = backup_file ? game_read(backup_file, &null_backend, NULL) : game_new(&null_backend, NULL);
+
+        if (backup_file) {
+            fclose(backup_file);
+        }
+
+        Uint32 game_end = SDL_GetTicks();
+
+        game_add_backend(game, &sdl_backend, NULL);
+
+        Uint32 backend_end = SDL_GetTicks();
+
+        printf("Startup: %s %u ms, window and sprites %u ms\n", backup_file ? "backup file" : "data file and maps", game_end - start, backend_end - game_end);
+
+        game_free(game);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 2 && strcmp(argv[1], "--bench-checkpoints") == 0) {
+        struct game *game = game_new(&null_backend, NULL);
+
+        game_bench_checkpoints(game, atoi(argv[2]));
+
+        game_free(game);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    if (argc > 2 && strcmp(argv[1], "--soak-levels") == 0) {
+        struct game *game = game_new(&sdl_backend, NULL);
+
+        game_soak_levels(game, atoi(argv[2]));
+
+        game_free(game);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
     struct game *game = NULL;
 
-    FILE *backup_file = fopen(BACKUP_FILE, "rb");
+    // replays and headless runs start from a new game, leaving the backup for later
+    FILE *backup_file = record_file || replay_file || is_headless ? NULL : fopen(BACKUP_FILE, "rb");
 
     if (backup_file) {
-        game = game_read(backup_file);
+        game = game_read(backup_file, backend, argument);
         fclose(backup_file);
         remove(BACKUP_FILE);
     } else {
-        game = game_new();
+        game = game_new(backend, argument);
+    }
+
+    // only a monitored game reports its latencies, the other ones leave the terminal clean
+    if (monitor) {
+        game_add_backend(game, monitor, monitor_argument);
+        game_report_latency(game);
+    }
+
+    if (record_file) {
+        game_record(game, record_file);
+    } else if (replay_file) {
+        game_replay(game, replay_file);
+
+        if (replay_tick > 0 && game_seek(game, replay_tick)) {
+            game_free(game);
+            SDL_Quit();
+
+            return EXIT_SUCCESS;
+        }
+    } else if (!is_headless) {
+        game_autosave(game, BACKUP_FILE);
+        game_enable_rewind(game);
     }
 
-    SDL_EnableKeyRepeat(SDL_DEFAULT_REPEAT_DELAY, SDL_DEFAULT_REPEAT_INTERVAL);
+    // without frames to pace nor anything to draw, the game ticks follow each other as fast as possible
+    if (backend->frame_rate == 0) {
+        while (!game_update(game)) {
+        }
+
+        game_free(game);
+        SDL_Quit();
+
+        return EXIT_SUCCESS;
+    }
+
+    Uint32 tick_duration = 1000 / DEFAULT_GAME_FPS;
+
+    Uint32 frame_duration = 1000 / backend->frame_rate;
+    struct simulation *simulation = simulation_new(game);
+
+    // the game logic runs on its own thread, the frames drawn between two ticks interpolate the moves
+    while (!simulation_is_over(simulation)) {
+        Uint32 frame_start = SDL_GetTicks();
 
-    int ideal_duration = 1000 / DEFAULT_GAME_FPS;
+        game_pump(game);
 
-    struct timer *timer = timer_new();
-    int done = 0;
+        const struct snapshot *snapshot = simulation_get_snapshot(simulation);
+        Uint32 elapsed = SDL_GetTicks() - snapshot->time;
 
-    while (!done) {
-        timer_start(timer, ideal_duration);
+        game_display(game, snapshot, elapsed < tick_duration ? (double) elapsed / tick_duration : 1);
 
-        done = game_update(game);
-        game_display(game);
+        // the timers follow the game ticks, the frames follow the wall clock
+        Uint32 elapsed_frame = SDL_GetTicks() - frame_start;
 
-        timer_update(timer);
-        if (timer_is_over(timer) == 0) {
-            SDL_Delay(timer_get_remaining(timer));
+        if (elapsed_frame < frame_duration) {
+            SDL_Delay(frame_duration - elapsed_frame);
         }
     }
 
-    timer_free(timer);
+    simulation_free(simulation);
     game_free(game);
 
     SDL_Quit();
@@ -1,15 +1,27 @@
 #include "../include/map.h"
+#include "../include/random.h"
 #include "../include/constant.h"
+#include "../include/misc.h"
 #include <unistd.h>
 #include <assert.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 /**
  * @brief Macro to calculate the index of a cell in the map given its row and column.
  */
 #define CELL(i, j) ((i) + (j) * map->width)
 
+/**
+ * @brief Value of a cell holding a bomb whose fuse burns, the state of the fuse is not stored in the grid.
+ */
+#define CELL_LIT_BOMB (CELL_BOMB | INIT)
+
+/**
+ * @brief Maximum width or height of a map read from a buffer, against corrupted states.
+ */
+#define MAX_MAP_SIZE 1024
+
 /**
  * @brief Structure representing a map.
  */
@@ -19,9 +31,36 @@ struct map {
     unsigned char *grid; /**< Grid of the map */
     struct bomb_node *bomb_head; /**< Head of the bombs' linked list */
     struct monster_node *monster_head; /**< Head of the monsters' linked list */
+    struct monster_node **monster_cells; /**< Monster standing on each cell, NULL if none */
+    unsigned char *bomb_sprites; /**< Bomb state drawn on each cell plus one, 0 if none, only built for the snapshots */
     enum strategy monsters_strategy; /**< The strategy of the monsters (RANDOM, DIJKSTRA) */
+    int first_changed_row; /**< First row of the grid changed since map_clear_changes, height if none */
+    int last_changed_row; /**< Last row of the grid changed since map_clear_changes, -1 if none */
+    int are_entities_changed; /**< Were bombs or monsters changed since map_clear_changes ? */
 };
 
+static void index_cells(struct map *map) {
+    assert(map);
+
+    map->monster_cells = calloc(map->width * map->height, sizeof(struct monster_node *));
+
+    if (!map->monster_cells) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    map->bomb_sprites = malloc(map->width * map->height);
+
+    if (!map->bomb_sprites) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        map->monster_cells[CELL(monster_node_get_x(current), monster_node_get_y(current))] = current;
+    }
+}
+
 struct map *map_new(char *filename) {
     assert(filename);
 
@@ -64,6 +103,8 @@ struct map *map_new(char *filename) {
     map->bomb_head = NULL;
     map->monster_head = NULL;
 
+    index_cells(map);
+
     for (int i = 0; i < map_get_width(map); i++) {
         for (int j = 0; j < map_get_height(map); j++) {
 
@@ -79,6 +120,8 @@ struct map *map_new(char *filename) {
         }
     }
 
+    map_clear_changes(map);
+
     return map;
 }
 
@@ -101,28 +144,91 @@ void map_free(struct map *map) {
         current_bomb = next;
     }
 
+    free(map->bomb_sprites);
+    free(map->monster_cells);
     free(map->grid);
     free(map);
 }
 
-void map_write(struct map *map, FILE *file) {
+static void write_entities(struct map *map, struct buffer *buffer) {
     assert(map);
-    assert(file);
+    assert(buffer);
 
-    fwrite(map, sizeof(struct map), 1, file);
-    fwrite(map->grid, map->width * map->height, 1, file);
+    int num_bombs = 0;
+    int num_monsters = 0;
 
     for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
-        bomb_node_write(current, file);
+        num_bombs++;
     }
 
     for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
-        monster_node_write(current, file);
+        num_monsters++;
+    }
+
+    // the lists keep their order, the monsters move in the same order once read
+    buffer_write_varint(buffer, (Uint32) num_bombs);
+
+    for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
+        bomb_node_serialize(current, buffer);
+    }
+
+    buffer_write_varint(buffer, (Uint32) num_monsters);
+
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        monster_node_serialize(current, buffer);
+    }
+}
+
+static void read_entities(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(!map->bomb_head && !map->monster_head);
+    assert(buffer);
+
+    int num_bombs = (int) buffer_read_varint(buffer);
+    struct bomb_node *last_bomb = NULL;
+
+    for (int i = 0; i < num_bombs; i++) {
+        struct bomb_node *bomb = bomb_node_deserialize(buffer);
+
+        if (last_bomb) {
+            bomb_node_set_next(last_bomb, bomb);
+        } else {
+            map->bomb_head = bomb;
+        }
+
+        last_bomb = bomb;
     }
+
+    int num_monsters = (int) buffer_read_varint(buffer);
+    struct monster_node *last_monster = NULL;
+
+    for (int i = 0; i < num_monsters; i++) {
+        struct monster_node *monster = monster_node_deserialize(buffer);
+
+        if (last_monster) {
+            monster_node_set_next(last_monster, monster);
+        } else {
+            map->monster_head = monster;
+        }
+
+        last_monster = monster;
+    }
+}
+
+void map_serialize(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(buffer);
+
+    buffer_write_varint(buffer, (Uint32) map->width);
+    buffer_write_varint(buffer, (Uint32) map->height);
+    buffer_write_bytes(buffer, map->grid, map->width * map->height);
+    buffer_write_varint(buffer, map->monsters_strategy);
+
+    write_entities(map, buffer);
 }
 
-struct map *map_read(FILE *file) {
-    assert(file);
+struct map *map_deserialize(struct buffer *buffer) {
+    assert(buffer);
 
     struct map *map = malloc(sizeof(struct map));
 
@@ -131,36 +237,228 @@ struct map *map_read(FILE *file) {
         exit(EXIT_FAILURE);
     }
 
-    fread(map, sizeof(struct map), 1, file);
+    memset(map, 0, sizeof(struct map));
+
+    map->width = (int) buffer_read_varint(buffer);
+    map->height = (int) buffer_read_varint(buffer);
+
+    if (map->width <= 0 || map->height <= 0 || map->width > MAX_MAP_SIZE || map->height > MAX_MAP_SIZE) {
+        error("Corrupted state, map of %dx%d cells\n", map->width, map->height);
+    }
 
-    map->grid = malloc(sizeof(unsigned char) * map->width * map->height);
+    map->grid = malloc(map->width * map->height);
 
     if (!map->grid) {
         fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
         exit(EXIT_FAILURE);
     }
 
-    fread(map->grid, map->width * map->height, 1, file);
+    buffer_read_bytes(buffer, map->grid, map->width * map->height);
+    map->monsters_strategy = (enum strategy) buffer_read_varint(buffer);
 
-    if (map->bomb_head != NULL) {
+    read_entities(map, buffer);
+    index_cells(map);
+    map_clear_changes(map);
 
-        map->bomb_head = bomb_node_read(file);
+    return map;
+}
+
+void map_serialize_changes(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(buffer);
+
+    int num_rows = map->last_changed_row - map->first_changed_row + 1;
+
+    // the rows between the first and the last one changed, then every bomb and monster if any of them changed
+    if (num_rows > 0) {
+        buffer_write_varint(buffer, (Uint32) map->first_changed_row);
+        buffer_write_varint(buffer, (Uint32) num_rows);
+        buffer_write_bytes(buffer, map->grid + CELL(0, map->first_changed_row), num_rows * map->width);
+    } else {
+        buffer_write_varint(buffer, 0);
+        buffer_write_varint(buffer, 0);
+    }
+
+    buffer_write_varint(buffer, (Uint32) map->are_entities_changed);
+
+    if (map->are_entities_changed) {
+        write_entities(map, buffer);
+    }
+}
 
-        for (struct bomb_node *current = map->bomb_head; bomb_node_get_next(current) != NULL; current = bomb_node_get_next(current)) {
-            bomb_node_set_next(current, bomb_node_read(file));
+void map_deserialize_changes(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(buffer);
+
+    int first_row = (int) buffer_read_varint(buffer);
+    int num_rows = (int) buffer_read_varint(buffer);
+
+    if (first_row < 0 || num_rows < 0 || num_rows > map->height - first_row) {
+        error("Corrupted state, rows %d to %d of a map of %d rows\n", first_row, first_row + num_rows - 1, map->height);
+    }
+
+    buffer_read_bytes(buffer, map->grid + CELL(0, first_row), num_rows * map->width);
+
+    if (!buffer_read_varint(buffer)) {
+        return;
+    }
+
+    while (map->bomb_head) {
+        map_remove_bomb_node(map, map->bomb_head);
+    }
+
+    while (map->monster_head) {
+        map_remove_monster_node(map, map->monster_head);
+    }
+
+    read_entities(map, buffer);
+
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        map->monster_cells[CELL(monster_node_get_x(current), monster_node_get_y(current))] = current;
+    }
+}
+
+void map_clear_changes(struct map *map) {
+    assert(map);
+
+    map->first_changed_row = map->height;
+    map->last_changed_row = -1;
+    map->are_entities_changed = 0;
+}
+
+int map_has_changes(struct map *map) {
+    assert(map);
+    return map->last_changed_row >= 0 || map->are_entities_changed;
+}
+
+void map_checkpoint(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(buffer);
+
+    int num_bombs = 0;
+    int num_monsters = 0;
+
+    for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
+        num_bombs++;
+    }
+
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        num_monsters++;
+    }
+
+    buffer_write_bytes(buffer, &num_bombs, sizeof(int));
+    buffer_write_bytes(buffer, &num_monsters, sizeof(int));
+    buffer_write_bytes(buffer, map->grid, map->width * map->height);
+
+    for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
+        bomb_node_checkpoint(current, buffer);
+    }
+
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        monster_node_checkpoint(current, buffer);
+    }
+}
+
+static void rollback_bombs(struct map *map, struct buffer *buffer, int num_bombs) {
+    assert(map);
+    assert(buffer);
+
+    struct bomb_node *previous = NULL;
+    struct bomb_node *current = map->bomb_head;
+
+    for (int i = 0; i < num_bombs; i++) {
+        if (!current) {
+            current = bomb_node_new(0, 0, 1);
+
+            if (previous) {
+                bomb_node_set_next(previous, current);
+            } else {
+                map->bomb_head = current;
+            }
         }
+
+        bomb_node_rollback(current, buffer);
+
+        previous = current;
+        current = bomb_node_get_next(current);
     }
 
-    if (map->monster_head != NULL) {
+    // the bombs laid after the checkpoint are gone
+    if (previous) {
+        bomb_node_set_next(previous, NULL);
+    } else {
+        map->bomb_head = NULL;
+    }
+
+    while (current) {
+        struct bomb_node *next = bomb_node_get_next(current);
+
+        bomb_node_free(current);
+        current = next;
+    }
+}
+
+static void rollback_monsters(struct map *map, struct buffer *buffer, int num_monsters) {
+    assert(map);
+    assert(buffer);
 
-        map->monster_head = monster_node_read(file);
+    for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
+        map->monster_cells[CELL(monster_node_get_x(current), monster_node_get_y(current))] = NULL;
+    }
+
+    struct monster_node *previous = NULL;
+    struct monster_node *current = map->monster_head;
+
+    for (int i = 0; i < num_monsters; i++) {
+        if (!current) {
+            current = monster_node_new(0, 0);
 
-        for (struct monster_node *current = map->monster_head; monster_node_get_next(current) != NULL; current = monster_node_get_next(current)) {
-            monster_node_set_next(current, monster_node_read(file));
+            if (previous) {
+                monster_node_set_next(previous, current);
+            } else {
+                map->monster_head = current;
+            }
         }
+
+        monster_node_rollback(current, buffer);
+        map->monster_cells[CELL(monster_node_get_x(current), monster_node_get_y(current))] = current;
+
+        previous = current;
+        current = monster_node_get_next(current);
     }
 
-    return map;
+    if (previous) {
+        monster_node_set_next(previous, NULL);
+    } else {
+        map->monster_head = NULL;
+    }
+
+    while (current) {
+        struct monster_node *next = monster_node_get_next(current);
+
+        monster_node_free(current);
+        current = next;
+    }
+}
+
+void map_rollback(struct map *map, struct buffer *buffer) {
+    assert(map);
+    assert(buffer);
+
+    int num_bombs;
+    int num_monsters;
+
+    buffer_read_bytes(buffer, &num_bombs, sizeof(int));
+    buffer_read_bytes(buffer, &num_monsters, sizeof(int));
+    buffer_read_bytes(buffer, map->grid, map->width * map->height);
+
+    rollback_bombs(map, buffer, num_bombs);
+    rollback_monsters(map, buffer, num_monsters);
+
+    // any row and any entity may differ from the last save
+    map->first_changed_row = 0;
+    map->last_changed_row = map->height - 1;
+    map->are_entities_changed = 1;
 }
 
 int map_get_width(struct map *map) {
@@ -183,6 +481,8 @@ void map_set_grid(struct map *map, unsigned char *grid) {
     assert(grid);
 
     map->grid = grid;
+    map->first_changed_row = 0;
+    map->last_changed_row = map->height - 1;
 }
 
 void map_add_bomb_node(struct map *map, struct bomb_node *to_add) {
@@ -191,12 +491,15 @@ void map_add_bomb_node(struct map *map, struct bomb_node *to_add) {
 
     bomb_node_set_next(to_add, map->bomb_head);
     map->bomb_head = to_add;
+    map->are_entities_changed = 1;
 }
 
 void map_remove_bomb_node(struct map *map, struct bomb_node *to_remove) {
     assert(map);
     assert(to_remove);
 
+    map->are_entities_changed = 1;
+
     if (map->bomb_head == to_remove) {
         map->bomb_head = bomb_node_get_next(to_remove);
         bomb_node_free(to_remove);
@@ -219,14 +522,22 @@ void map_add_monster_node(struct map *map, struct monster_node *to_add) {
     assert(map);
     assert(to_add);
 
+    // monsters never share a cell
+    assert(!map_get_monster(map, monster_node_get_x(to_add), monster_node_get_y(to_add)));
+
     monster_node_set_next(to_add, map->monster_head);
     map->monster_head = to_add;
+    map->monster_cells[CELL(monster_node_get_x(to_add), monster_node_get_y(to_add))] = to_add;
+    map->are_entities_changed = 1;
 }
 
 void map_remove_monster_node(struct map *map, struct monster_node *to_remove) {
     assert(map);
     assert(to_remove);
 
+    map->monster_cells[CELL(monster_node_get_x(to_remove), monster_node_get_y(to_remove))] = NULL;
+    map->are_entities_changed = 1;
+
     if (map->monster_head == to_remove) {
         map->monster_head = monster_node_get_next(to_remove);
         monster_node_free(to_remove);
@@ -244,6 +555,23 @@ void map_remove_monster_node(struct map *map, struct monster_node *to_remove) {
     }
 }
 
+struct monster_node *map_get_monster(struct map *map, int x, int y) {
+    assert(map);
+    assert(map_is_inside(map, x, y));
+
+    return map->monster_cells[CELL(x, y)];
+}
+
+void map_move_monster(struct map *map, struct monster_node *monster, enum direction direction) {
+    assert(map);
+    assert(monster);
+
+    map->monster_cells[CELL(monster_node_get_x(monster), monster_node_get_y(monster))] = NULL;
+    monster_node_move(monster, direction);
+    map->monster_cells[CELL(monster_node_get_x(monster), monster_node_get_y(monster))] = monster;
+    map->are_entities_changed = 1;
+}
+
 struct bomb_node *map_get_bomb_head(struct map *map) {
     assert(map);
     return map->bomb_head;
@@ -283,53 +611,101 @@ void map_set_cell_value(struct map *map, int x, int y, unsigned char value) {
     assert(map_is_inside(map, x, y));
 
     map->grid[CELL(x, y)] = value;
+
+    if (y < map->first_changed_row) {
+        map->first_changed_row = y;
+    }
+
+    if (y > map->last_changed_row) {
+        map->last_changed_row = y;
+    }
 }
 
-void map_display(struct map *map, SDL_Surface *window, struct sprites *sprites) {
+static void set_bomb_sprite(struct map *map, int x, int y, enum bomb_state state) {
     assert(map);
-    assert(window);
-    assert(sprites);
 
-    for (int i = 0; i < map_get_width(map); i++) {
-        for (int j = 0; j < map_get_height(map); j++) {
-            int x = i * SIZE_BLOC;
-            int y = j * SIZE_BLOC;
+    if (!map_is_inside(map, x, y)) {
+        return;
+    }
 
-            unsigned char type = map_get_cell_value(map, i, j);
+    // an explosion hides a bomb still burning on the same cell
+    unsigned char *sprite = &map->bomb_sprites[CELL(x, y)];
 
-            switch ((enum cell_type) (type & 0xf0)) {
-                case CELL_SCENERY:
-                    window_display_image(window, sprites_get_scenery(sprites, (enum scenery_type) (type & 0x0f)), x, y);
-                    break;
+    if (*sprite == 0 || state == EXPLODING) {
+        *sprite = (unsigned char) (state + 1);
+    }
+}
 
-                case CELL_BOX:
-                    window_display_image(window, sprites_get_box(sprites), x, y);
-                    break;
+void map_build_bomb_sprites(struct map *map) {
+    assert(map);
 
-                case CELL_BONUS:
-                    window_display_image(window, sprites_get_bonus(sprites, (enum bonus_type) (type & 0x0f)), x, y);
-                    break;
+    memset(map->bomb_sprites, 0, map->width * map->height);
 
-                case CELL_KEY:
-                    window_display_image(window, sprites_get_key(sprites), x, y);
-                    break;
+    // the fuses and the explosions are drawn from the bombs, the grid only tells where the bombs are
+    for (struct bomb_node *bomb = map->bomb_head; bomb != NULL; bomb = bomb_node_get_next(bomb)) {
+        int x = bomb_node_get_x(bomb);
+        int y = bomb_node_get_y(bomb);
+        enum bomb_state state = bomb_node_get_state(bomb);
 
-                case CELL_DOOR:
-                    window_display_image(window, sprites_get_door(sprites, (enum door_status) (type & 0x01)), x, y);
-                    break;
+        // a bomb just laid isn't drawn until its fuse starts burning
+        if (state == INIT) {
+            continue;
+        }
 
-                case CELL_BOMB:
-                    window_display_image(window, sprites_get_bomb(sprites, (type & 0x0f)), x, y);
-                    break;
+        if (state != EXPLODING) {
+            set_bomb_sprite(map, x, y, state);
+        } else {
+            set_bomb_sprite(map, x, y, EXPLODING);
 
-                default:
-                    break;
+            for (enum direction direction = NORTH; direction < NUM_DIRECTIONS; direction++) {
+                for (int i = 1; i <= bomb_node_get_direction_range(bomb, direction); i++) {
+                    set_bomb_sprite(map, direction_get_x(direction, x, i), direction_get_y(direction, y, i), EXPLODING);
+                }
             }
         }
     }
+}
+
+int map_is_exploding(struct map *map, int x, int y) {
+    assert(map);
+
+    // the blasts are only kept on the bombs, as the range reached in each direction
+    for (struct bomb_node *bomb = map->bomb_head; bomb != NULL; bomb = bomb_node_get_next(bomb)) {
+        int bomb_x = bomb_node_get_x(bomb);
+        int bomb_y = bomb_node_get_y(bomb);
+
+        if (bomb_node_get_state(bomb) != EXPLODING || (x != bomb_x && y != bomb_y)) {
+            continue;
+        }
+
+        if (x == bomb_x && y == bomb_y) {
+            return 1;
+        }
+
+        enum direction direction = direction_get_from_coordinates(bomb_x, bomb_y, x, y);
+
+        if (abs(x - bomb_x) + abs(y - bomb_y) <= bomb_node_get_direction_range(bomb, direction)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+enum bomb_state map_get_bomb_sprite(struct map *map, int x, int y) {
+    assert(map);
+    assert(map_is_inside(map, x, y));
+
+    return (enum bomb_state) (map->bomb_sprites[CELL(x, y)] - 1);
+}
+
+void map_save_positions(struct map *map) {
+    assert(map);
+
+    map->are_entities_changed = 1;
 
     for (struct monster_node *current = map->monster_head; current != NULL; current = monster_node_get_next(current)) {
-        monster_node_display(current, window, sprites);
+        monster_node_save_position(current);
     }
 }
 
@@ -354,11 +730,7 @@ static void set_bonus(struct map *map, int x, int y) {
     enum bonus_type bonus_type = map_get_cell_value(map, x, y) & 0x0f;
 
     if (bonus_type == RANDOM) {
-        static int i = 0;
-
-        srand(time(NULL) + i++);
-
-        bonus_type = rand() % NUM_BONUS_TYPES;
+        bonus_type = random_get_int(NUM_BONUS_TYPES);
     }
 
     if (bonus_type == BONUS_MONSTER) {
@@ -370,17 +742,6 @@ static void set_bonus(struct map *map, int x, int y) {
     }
 }
 
-static struct monster_node *is_explosion_reaching_monster(int x_explosion, int y_explosion, struct monster_node *monster_head) {
-
-    for (struct monster_node *current = monster_head; current != NULL; current = monster_node_get_next(current)) {
-        if (monster_node_get_x(current) == x_explosion && monster_node_get_y(current) == y_explosion) {
-            return current;
-        }
-    }
-
-    return NULL;
-}
-
 static int is_explosion_reaching_player(int explosion_x, int explosion_y, struct player *player) {
     assert(player);
 
@@ -399,6 +760,25 @@ static int can_bomb_propagate(enum cell_type cell_type) {
     return 0;
 }
 
+static int ignite_bombs(struct map *map, struct bomb_node *bomb, int x, int y) {
+    assert(map);
+    assert(bomb);
+
+    int num_ignited = 0;
+
+    // the bombs still burning on the cell explode right after
+    for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
+        if (current != bomb && bomb_node_get_x(current) == x && bomb_node_get_y(current) == y && bomb_node_get_state(current) != EXPLODING) {
+            bomb_node_set_state(current, TTL1);
+            timer_start(bomb_node_get_timer(current), 60);
+            map->are_entities_changed = 1;
+            num_ignited++;
+        }
+    }
+
+    return num_ignited;
+}
+
 static void propagate_bomb_explosion(struct map *map, struct player *player, struct bomb_node *current_bomb, enum direction dir) {
     assert(map);
     assert(player);
@@ -431,54 +811,39 @@ static void propagate_bomb_explosion(struct map *map, struct player *player, str
 
         }
 
-        if ((cell_value & 0xf0) == CELL_BOMB && cell_value != (CELL_BOMB | EXPLODING)) {
-
-            for (struct bomb_node *current = map->bomb_head; current != NULL; current = bomb_node_get_next(current)) {
-                if (current != current_bomb && bomb_node_get_x(current) == x && bomb_node_get_y(current) == y) {
-                    bomb_node_set_state(current, TTL1);
-                    timer_start(bomb_node_get_timer(current), 60);
-                }
-            }
-
+        // the blast goes through the bombs already exploding
+        if ((cell_value & 0xf0) == CELL_BOMB && ignite_bombs(map, current_bomb, x, y)) {
             bomb_node_set_direction_range(current_bomb, dir, range - 1);
 
             return;
 
         }
 
+        // the bonuses are burnt, the other cells the blast goes through are left as they are
+        if ((cell_value & 0xf0) == CELL_BONUS) {
+            map_set_cell_value(map, x, y, CELL_EMPTY);
+        }
+
         if (is_explosion_reaching_player(x, y, player)) {
             player_dec_num_lives(player);
-            map_set_cell_value(map, x, y, CELL_BOMB | EXPLODING);
             bomb_node_set_direction_range(current_bomb, dir, range);
 
             return;
 
         }
 
-        if ((dead_monster = is_explosion_reaching_monster(x, y, map->monster_head)) != NULL) {
+        if ((dead_monster = map_get_monster(map, x, y)) != NULL) {
             map_remove_monster_node(map, dead_monster);
-            map_set_cell_value(map, x, y, CELL_BOMB | EXPLODING);
             bomb_node_set_direction_range(current_bomb, dir, range);
 
             return;
 
         }
-
-        map_set_cell_value(map, x, y, CELL_BOMB | EXPLODING);
     }
 
     bomb_node_set_direction_range(current_bomb, dir, player_get_range_bombs(player));
 }
 
-static void clean_explosion_cells(struct map *map, struct bomb_node *bomb, enum direction direction) {
-    assert(map);
-    assert(bomb);
-
-    for (int i = 1; i <= bomb_node_get_direction_range(bomb, direction); i++) {
-        map_set_cell_value(map, direction_get_x(direction, bomb_node_get_x(bomb), i), direction_get_y(direction, bomb_node_get_y(bomb), i), CELL_EMPTY);
-    }
-}
-
 void map_update_bombs(struct map *map, struct player *player) {
     assert(map);
     assert(player);
@@ -494,15 +859,20 @@ void map_update_bombs(struct map *map, struct player *player) {
             continue;
         }
 
+        // the timers only change the state once over, until then they follow the clock written with the game
+        map->are_entities_changed = 1;
         bomb_node_dec_state(current);
 
         switch (bomb_node_get_state(current)) {
 
             case TTL4:
+                map_set_cell_value(map, bomb_node_get_x(current), bomb_node_get_y(current), CELL_LIT_BOMB);
+                break;
+
             case TTL3:
             case TTL2:
             case TTL1:
-                map_set_cell_value(map, bomb_node_get_x(current), bomb_node_get_y(current), CELL_BOMB | bomb_node_get_state(current));
+                // the fuse burns, the grid is unchanged until the explosion
                 break;
 
             case EXPLODING:
@@ -510,15 +880,9 @@ void map_update_bombs(struct map *map, struct player *player) {
                     player_dec_num_lives(player);
                 }
 
-                for (struct bomb_node *current_bomb = map->bomb_head; current_bomb != NULL; current_bomb = bomb_node_get_next(current_bomb)) {
-                    if (current_bomb != current && bomb_node_get_x(current_bomb) == bomb_node_get_x(current) && bomb_node_get_y(current_bomb) == bomb_node_get_y(current) && bomb_node_get_state(current_bomb) != EXPLODING) {
-                        bomb_node_set_state(current_bomb, TTL1);
-                        timer_start(bomb_node_get_timer(current_bomb), 60);
-                    }
-                }
-
-                map_set_cell_value(map, bomb_node_get_x(current), bomb_node_get_y(current), CELL_BOMB | bomb_node_get_state(current));
+                ignite_bombs(map, current, bomb_node_get_x(current), bomb_node_get_y(current));
 
+                // the bomb stays on its cell until the blast is over, the blast itself is only on the bomb
                 propagate_bomb_explosion(map, player, current, NORTH);
                 propagate_bomb_explosion(map, player, current, SOUTH);
                 propagate_bomb_explosion(map, player, current, EAST);
@@ -529,11 +893,6 @@ void map_update_bombs(struct map *map, struct player *player) {
             default:
                 map_set_cell_value(map, bomb_node_get_x(current), bomb_node_get_y(current), CELL_EMPTY);
 
-                clean_explosion_cells(map, current, NORTH);
-                clean_explosion_cells(map, current, SOUTH);
-                clean_explosion_cells(map, current, EAST);
-                clean_explosion_cells(map, current, WEST);
-
                 struct bomb_node *next = bomb_node_get_next(current);
                 map_remove_bomb_node(map, current);
                 current = next;
@@ -546,17 +905,6 @@ void map_update_bombs(struct map *map, struct player *player) {
     }
 }
 
-static int will_box_be_blocked_by_monsters(struct monster_node *monster_head, int x_dest, int y_dest) {
-
-    for (struct monster_node *current = monster_head; current != NULL; current = monster_node_get_next(current)) {
-        if (monster_node_get_x(current) == x_dest && monster_node_get_y(current) == y_dest) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
 static int is_box_pushable(struct map *map, int x_dest, int y_dest) {
     assert(map);
 
@@ -564,24 +912,13 @@ static int is_box_pushable(struct map *map, int x_dest, int y_dest) {
         return 0;
     }
 
-    if ((map_get_cell_value(map, x_dest, y_dest) & 0xf0) == CELL_EMPTY && !will_box_be_blocked_by_monsters(map->monster_head, x_dest, y_dest)) {
+    if ((map_get_cell_value(map, x_dest, y_dest) & 0xf0) == CELL_EMPTY && !map_get_monster(map, x_dest, y_dest)) {
         return 1;
     }
 
     return 0;
 }
 
-static int will_player_meet_a_monster(int player_next_x, int player_next_y, struct monster_node *monster_head) {
-
-    for (struct monster_node *current = monster_head; current != NULL; current = monster_node_get_next(current)) {
-        if (monster_node_get_x(current) == player_next_x && monster_node_get_y(current) == player_next_y) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
 int map_move_player(struct map *map, struct player *player, enum direction direction) {
     assert(player);
     assert(map);
@@ -593,7 +930,7 @@ int map_move_player(struct map *map, struct player *player, enum direction direc
         return 0;
     }
 
-    if (will_player_meet_a_monster(next_x, next_y, map->monster_head)) {
+    if (map_get_monster(map, next_x, next_y)) {
         player_dec_num_lives(player);
         return 0;
     }
@@ -630,13 +967,6 @@ int map_move_player(struct map *map, struct player *player, enum direction direc
 
             break;
 
-        case CELL_BOMB:
-            if ((cell & 0x0f) == EXPLODING) {
-                player_dec_num_lives(player);
-            }
-
-            break;
-
         case CELL_KEY:
             player_inc_num_keys(player);
             map_set_cell_value(map, next_x, next_y, CELL_EMPTY);
@@ -654,24 +984,15 @@ int map_move_player(struct map *map, struct player *player, enum direction direc
             break;
     }
 
+    if (map_is_exploding(map, next_x, next_y)) {
+        player_dec_num_lives(player);
+    }
+
     player_move(player, direction);
 
     return 1;
 }
 
-int map_will_monster_meet_other_monsters(struct monster_node *current_monster, struct monster_node *monster_head, enum direction current_monster_direction) {
-    assert(current_monster);
-    assert(monster_head);
-
-    for (struct monster_node *current = monster_head; current != NULL; current = monster_node_get_next(current)) {
-        if (monster_node_get_x(current) == direction_get_x(current_monster_direction, monster_node_get_x(current_monster), 1) && monster_node_get_y(current) == direction_get_y(current_monster_direction, monster_node_get_y(current_monster), 1)) {
-            return 1;
-        }
-    }
-
-    return 0;
-}
-
 int map_can_monster_move(struct map *map, struct player *player, struct monster_node *monster, enum direction monster_direction) {
     assert(map);
     assert(player);
@@ -684,7 +1005,7 @@ int map_can_monster_move(struct map *map, struct player *player, struct monster_
         return 0;
     }
 
-    if (map_will_monster_meet_other_monsters(monster, map->monster_head, monster_direction)) {
+    if (map_get_monster(map, x, y) || map_is_exploding(map, x, y)) {
         return 0;
     }
 
@@ -712,7 +1033,8 @@ int map_will_monster_meet_player(struct monster_node *monster, struct player *pl
     return 0;
 }
 
-void map_monster_meeting_player(struct monster_node *monster, struct player *player, enum direction monster_direction) {
+void map_monster_meeting_player(struct map *map, struct monster_node *monster, struct player *player, enum direction monster_direction) {
+    assert(map);
     assert(monster);
     assert(player);
 
@@ -720,5 +1042,8 @@ void map_monster_meeting_player(struct monster_node *monster, struct player *pla
 
     player_dec_num_lives(player);
 
+    // the monster waits for another move duration where it is, without sliding again
+    monster_node_save_position(monster);
     timer_start(monster_node_get_timer(monster), DURATION_MONSTER_MOVE);
+    map->are_entities_changed = 1;
 }
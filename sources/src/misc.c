@@ -3,6 +3,8 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <time.h>
+#include <unistd.h>
 
 void error(const char *s, ...) {
     va_list ap;
@@ -22,3 +24,43 @@ SDL_Surface *image_load(const char *filename) {
 
     return img;
 }
+
+int get_num_processors(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+    long num_processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (num_processors > 0) {
+        return (int) num_processors;
+    }
+#endif
+
+    return 1;
+}
+
+size_t get_resident_memory(void) {
+    size_t resident = 0;
+    unsigned long num_pages, num_resident_pages;
+    FILE *statm = fopen("/proc/self/statm", "r");
+
+    if (!statm) {
+        return 0;
+    }
+
+    if (fscanf(statm, "%lu %lu", &num_pages, &num_resident_pages) == 2) {
+        resident = (size_t) num_resident_pages * (size_t) sysconf(_SC_PAGESIZE);
+    }
+
+    fclose(statm);
+
+    return resident;
+}
+
+Uint64 get_monotonic_time(void) {
+    struct timespec now;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &now) != 0) {
+        error("Can't read the monotonic clock\n");
+    }
+
+    return (Uint64) now.tv_sec * 1000000 + (Uint64) (now.tv_nsec / 1000);
+}
@@ -10,6 +10,8 @@
 struct monster_node {
     int x; /**< X-coordinate of the monster node */
     int y; /**< Y-coordinate of the monster node */
+    int previous_x; /**< X-coordinate of the monster node before its last move */
+    int previous_y; /**< Y-coordinate of the monster node before its last move */
     enum direction direction; /**< Current direction of the monster node */
     struct timer *timer; /**< Timer for the monster node */
     struct monster_node *next; /**< Pointer to the next monster node */
@@ -28,6 +30,7 @@ struct monster_node *monster_node_new(int x, int y) {
 
     monster_node_set_x(monster_node, x);
     monster_node_set_y(monster_node, y);
+    monster_node_save_position(monster_node);
     monster_node_set_direction(monster_node, WEST);
     monster_node->timer = timer_new();
     timer_start(monster_node->timer, DURATION_MONSTER_MOVE);
@@ -44,16 +47,20 @@ void monster_node_free(struct monster_node *monster_node) {
     free(monster_node);
 }
 
-void monster_node_write(struct monster_node *monster_node, FILE *file) {
+void monster_node_serialize(struct monster_node *monster_node, struct buffer *buffer) {
     assert(monster_node);
-    assert(file);
+    assert(buffer);
 
-    fwrite(monster_node, sizeof(struct monster_node), 1, file);
-    timer_write(monster_node->timer, file);
+    buffer_write_int(buffer, monster_node->x);
+    buffer_write_int(buffer, monster_node->y);
+    buffer_write_int(buffer, monster_node->previous_x);
+    buffer_write_int(buffer, monster_node->previous_y);
+    buffer_write_int(buffer, monster_node->direction);
+    timer_serialize(monster_node->timer, buffer);
 }
 
-struct monster_node *monster_node_read(FILE *file) {
-    assert(file);
+struct monster_node *monster_node_deserialize(struct buffer *buffer) {
+    assert(buffer);
 
     struct monster_node *monster_node = malloc(sizeof(struct monster_node));
 
@@ -62,13 +69,40 @@ struct monster_node *monster_node_read(FILE *file) {
         exit(EXIT_FAILURE);
     }
 
-    fread(monster_node, sizeof(struct monster_node), 1, file);
-
-    monster_node->timer = timer_read(file);
+    monster_node->x = buffer_read_int(buffer);
+    monster_node->y = buffer_read_int(buffer);
+    monster_node->previous_x = buffer_read_int(buffer);
+    monster_node->previous_y = buffer_read_int(buffer);
+    monster_node->direction = (enum direction) buffer_read_int(buffer);
+    monster_node->timer = timer_deserialize(buffer);
+    monster_node->next = NULL;
 
     return monster_node;
 }
 
+void monster_node_checkpoint(struct monster_node *monster_node, struct buffer *buffer) {
+    assert(monster_node);
+    assert(buffer);
+
+    buffer_write_bytes(buffer, monster_node, sizeof(struct monster_node));
+    timer_checkpoint(monster_node->timer, buffer);
+}
+
+void monster_node_rollback(struct monster_node *monster_node, struct buffer *buffer) {
+    assert(monster_node);
+    assert(buffer);
+
+    struct timer *timer = monster_node->timer;
+    struct monster_node *next = monster_node->next;
+
+    // the pointers copied are the ones of the node at the time of the checkpoint
+    buffer_read_bytes(buffer, monster_node, sizeof(struct monster_node));
+    monster_node->timer = timer;
+    monster_node->next = next;
+
+    timer_rollback(timer, buffer);
+}
+
 int monster_node_get_x(struct monster_node *monster_node) {
     assert(monster_node);
     return monster_node->x;
@@ -121,18 +155,28 @@ struct timer *monster_node_get_timer(struct monster_node *monster_node) {
     return monster_node->timer;
 }
 
-void monster_node_display(struct monster_node *monster_node, SDL_Surface *window, struct sprites *sprites) {
+void monster_node_save_position(struct monster_node *monster_node) {
+    assert(monster_node);
+
+    monster_node->previous_x = monster_node->x;
+    monster_node->previous_y = monster_node->y;
+}
+
+int monster_node_get_previous_x(struct monster_node *monster_node) {
     assert(monster_node);
-    assert(window);
-    assert(sprites);
+    return monster_node->previous_x;
+}
 
-    window_display_image(window, sprites_get_monster(sprites, monster_node->direction), monster_node->x * SIZE_BLOC, monster_node->y * SIZE_BLOC);
+int monster_node_get_previous_y(struct monster_node *monster_node) {
+    assert(monster_node);
+    return monster_node->previous_y;
 }
 
 void monster_node_move(struct monster_node *monster_node, enum direction direction) {
     assert(monster_node);
 
     monster_node_set_direction(monster_node, direction);
+    monster_node_save_position(monster_node);
 
     monster_node_set_x(monster_node, direction_get_x(direction, monster_node_get_x(monster_node), 1));
     monster_node_set_y(monster_node, direction_get_y(direction, monster_node_get_y(monster_node), 1));
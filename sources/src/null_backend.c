@@ -0,0 +1,126 @@
+#include "../include/backend.h"
+#include "../include/misc.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Maximum length of a line of a script, including the line feed and the terminating null byte.
+ */
+#define SCRIPT_LINE_LENGTH 256
+
+/**
+ * @brief Structure representing the state of the null backend.
+ */
+struct null_backend {
+    FILE *script; /**< Script giving the commands, NULL if there is none */
+    char line[SCRIPT_LINE_LENGTH]; /**< Commands of the current game tick */
+    char *next; /**< Next command to read in the line, NULL once the line is read */
+    int line_number; /**< Number of the current line, for the error messages */
+};
+
+static void *null_open(struct game *game, const char *argument) {
+    (void) game;
+
+    struct null_backend *backend = malloc(sizeof(struct null_backend));
+
+    if (!backend) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(backend, 0, sizeof(struct null_backend));
+
+    // an empty argument gives no command at all, the game runs until it ends by itself
+    if (argument && *argument == '\0') {
+        return backend;
+    }
+
+    backend->script = argument ? fopen(argument, "r") : stdin;
+
+    if (!backend->script) {
+        error("Can't open script %s\n", argument);
+    }
+
+    return backend;
+}
+
+static void null_close(void *data) {
+    struct null_backend *backend = data;
+
+    assert(backend);
+
+    if (backend->script && backend->script != stdin) {
+        fclose(backend->script);
+    }
+
+    free(backend);
+}
+
+static void null_display(void *data, const struct snapshot *snapshot, double alpha) {
+    (void) data;
+    (void) snapshot;
+    (void) alpha;
+}
+
+static void null_pump(void *data) {
+    (void) data;
+}
+
+static enum action null_poll(void *data, Uint64 *time) {
+    struct null_backend *backend = data;
+
+    assert(backend);
+    assert(time);
+
+    // the script is read when the game asks for it
+    *time = get_monotonic_time();
+
+    if (!backend->script) {
+        return ACTION_NONE;
+    }
+
+    if (!backend->next) {
+        // every line is a game tick, the game ends with the script
+        if (!fgets(backend->line, sizeof(backend->line), backend->script)) {
+            return ACTION_QUIT;
+        }
+
+        backend->line_number++;
+        backend->line[strcspn(backend->line, "#")] = '\0';
+        backend->next = backend->line;
+    }
+
+    char *name = backend->next + strspn(backend->next, " \t\r\n");
+
+    if (*name == '\0') {
+        backend->next = NULL;
+        return ACTION_NONE;
+    }
+
+    backend->next = name + strcspn(name, " \t\r\n");
+
+    if (*backend->next != '\0') {
+        *backend->next = '\0';
+        backend->next++;
+    }
+
+    enum action action = backend_get_action(name);
+
+    if (action == ACTION_NONE) {
+        error("Unknown action %s on line %d of the script\n", name, backend->line_number);
+    }
+
+    return action;
+}
+
+const struct backend null_backend = {
+    SDL_INIT_TIMER,
+    0,
+    null_open,
+    null_close,
+    null_display,
+    null_pump,
+    null_poll
+};
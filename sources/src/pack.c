@@ -0,0 +1,332 @@
+#include "../include/pack.h"
+#include "../include/misc.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PACK_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Magic number at the start of every pack file.
+ */
+#define PACK_MAGIC "BOMBPACK"
+
+/**
+ * @brief Version of the pack file layout, to be increased on every change of it.
+ */
+#define PACK_VERSION 1
+
+/**
+ * @brief Value written in native byte order, to reject packs baked on another architecture.
+ */
+#define PACK_BYTE_ORDER 0x01020304
+
+/**
+ * @brief Maximum length of the path of an image file, including the terminating null byte.
+ */
+#define PACK_PATH_LENGTH 64
+
+/**
+ * @brief Alignment (number of bytes) of the atlas pixels in the pack file.
+ */
+#define PACK_PIXELS_ALIGNMENT 64
+
+/**
+ * @brief Structure at the start of a pack file.
+ */
+struct pack_header {
+    char magic[8]; /**< PACK_MAGIC, without its null byte */
+    uint32_t version; /**< PACK_VERSION */
+    uint32_t byte_order; /**< PACK_BYTE_ORDER */
+    uint32_t num_sprites; /**< Number of entries following the header */
+    uint32_t width; /**< Width of the atlas */
+    uint32_t height; /**< Height of the atlas */
+    uint32_t pitch; /**< Length of a row of the atlas in bytes */
+    uint32_t Rmask, Gmask, Bmask, Amask; /**< Pixel format of the atlas */
+    uint32_t pixels_offset; /**< Offset of the atlas pixels from the start of the file */
+};
+
+/**
+ * @brief Structure describing a sprite in a pack file.
+ */
+struct pack_entry {
+    char filename[PACK_PATH_LENGTH]; /**< Path of the image file */
+    int64_t size; /**< Size of the image file when the pack was baked */
+    int64_t mtime; /**< Modification time of the image file when the pack was baked */
+    int32_t x, y, w, h; /**< Area of the sprite in the atlas */
+};
+
+/**
+ * @brief Structure representing an opened pack.
+ */
+struct pack {
+    void *mapping; /**< Pack file mapped in memory */
+    size_t size; /**< Size of the mapping */
+    SDL_Surface *atlas; /**< Atlas created on top of the mapped pixels */
+};
+
+static size_t get_pixels_offset(int num_sprites) {
+    size_t offset = sizeof(struct pack_header) + num_sprites * sizeof(struct pack_entry);
+
+    return (offset + PACK_PIXELS_ALIGNMENT - 1) / PACK_PIXELS_ALIGNMENT * PACK_PIXELS_ALIGNMENT;
+}
+
+static void get_display_masks(Uint32 masks[4]) {
+    SDL_Surface *probe = SDL_CreateRGBSurface(SDL_SWSURFACE, 1, 1, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+    SDL_Surface *converted = probe ? SDL_DisplayFormatAlpha(probe) : NULL;
+
+    if (!converted) {
+        error("Can't probe display format: %s\n", SDL_GetError());
+    }
+
+    masks[0] = converted->format->Rmask;
+    masks[1] = converted->format->Gmask;
+    masks[2] = converted->format->Bmask;
+    masks[3] = converted->format->Amask;
+
+    SDL_FreeSurface(converted);
+    SDL_FreeSurface(probe);
+}
+
+#ifdef PACK_MMAP
+
+static int is_source_unchanged(const struct pack_entry *entry, const char *filename) {
+    struct stat info;
+
+    if (entry->filename[PACK_PATH_LENGTH - 1] != '\0' || strcmp(entry->filename, filename) != 0) {
+        return 0;
+    }
+
+    if (stat(filename, &info) != 0) {
+        return 0;
+    }
+
+    return entry->size == (int64_t) info.st_size && entry->mtime == (int64_t) info.st_mtime;
+}
+
+static int is_pack_valid(const void *mapping, size_t size, const char **paths, int num_sprites) {
+    const struct pack_header *header = mapping;
+
+    if (size < sizeof(struct pack_header)
+        || memcmp(header->magic, PACK_MAGIC, sizeof(header->magic)) != 0
+        || header->version != PACK_VERSION
+        || header->byte_order != PACK_BYTE_ORDER
+        || header->num_sprites != (uint32_t) num_sprites
+        || header->pixels_offset != get_pixels_offset(num_sprites)
+        || header->pitch < header->width * 4
+        || header->pixels_offset + (size_t) header->pitch * header->height > size) {
+        return 0;
+    }
+
+    // the pixels were baked for the display format of the machine, not for this one
+    Uint32 masks[4];
+    get_display_masks(masks);
+
+    if (header->Rmask != masks[0] || header->Gmask != masks[1] || header->Bmask != masks[2] || header->Amask != masks[3]) {
+        return 0;
+    }
+
+    const struct pack_entry *entries = (const struct pack_entry *) (header + 1);
+
+    for (int i = 0; i < num_sprites; i++) {
+        const struct pack_entry *entry = &entries[i];
+
+        if (!is_source_unchanged(entry, paths[i])
+            || entry->x < 0 || entry->y < 0 || entry->w < 0 || entry->h < 0
+            || entry->x + entry->w > (int32_t) header->width
+            || entry->y + entry->h > (int32_t) header->height) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+#endif /* PACK_MMAP */
+
+struct pack *pack_open(const char *filename, const char **paths, int num_sprites) {
+    assert(filename);
+    assert(paths);
+
+#ifdef PACK_MMAP
+    int fd = open(filename, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+
+    // private writable pages: SDL may write to the pixels, the file is never modified
+    size_t size = (size_t) info.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (mapping == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (!is_pack_valid(mapping, size, paths, num_sprites)) {
+        fprintf(stderr, "%s is stale, decoding the sprite images\n", filename);
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    const struct pack_header *header = mapping;
+    SDL_Surface *atlas = SDL_CreateRGBSurfaceFrom((char *) mapping + header->pixels_offset, (int) header->width, (int) header->height, 32, (int) header->pitch, header->Rmask, header->Gmask, header->Bmask, header->Amask);
+
+    if (!atlas) {
+        error("Can't create sprite atlas: %s\n", SDL_GetError());
+    }
+
+    struct pack *pack = malloc(sizeof(struct pack));
+
+    if (!pack) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    pack->mapping = mapping;
+    pack->size = size;
+    pack->atlas = atlas;
+
+    return pack;
+#else
+    (void) num_sprites;
+    return NULL;
+#endif
+}
+
+void pack_close(struct pack *pack) {
+    assert(pack);
+
+    // the atlas points into the mapping, it must go first
+    SDL_FreeSurface(pack->atlas);
+
+#ifdef PACK_MMAP
+    munmap(pack->mapping, pack->size);
+#endif
+
+    free(pack);
+}
+
+SDL_Surface *pack_get_atlas(struct pack *pack) {
+    assert(pack);
+    return pack->atlas;
+}
+
+SDL_Rect pack_get_rect(struct pack *pack, int index) {
+    assert(pack);
+
+    const struct pack_header *header = pack->mapping;
+    const struct pack_entry *entry = (const struct pack_entry *) (header + 1) + index;
+    SDL_Rect rect;
+
+    assert(index >= 0 && (uint32_t) index < header->num_sprites);
+
+    rect.x = (Sint16) entry->x;
+    rect.y = (Sint16) entry->y;
+    rect.w = (Uint16) entry->w;
+    rect.h = (Uint16) entry->h;
+
+    return rect;
+}
+
+void pack_write(const char *filename, SDL_Surface *atlas, const char **paths, SDL_Rect *rects, int num_sprites) {
+    assert(filename);
+    assert(atlas);
+    assert(paths);
+    assert(rects);
+    assert(atlas->format->BytesPerPixel == 4);
+
+    struct pack_header header;
+
+    memset(&header, 0, sizeof(struct pack_header));
+    memcpy(header.magic, PACK_MAGIC, sizeof(header.magic));
+    header.version = PACK_VERSION;
+    header.byte_order = PACK_BYTE_ORDER;
+    header.num_sprites = (uint32_t) num_sprites;
+    header.width = (uint32_t) atlas->w;
+    header.height = (uint32_t) atlas->h;
+    header.pitch = (uint32_t) atlas->w * 4;
+    header.Rmask = atlas->format->Rmask;
+    header.Gmask = atlas->format->Gmask;
+    header.Bmask = atlas->format->Bmask;
+    header.Amask = atlas->format->Amask;
+    header.pixels_offset = (uint32_t) get_pixels_offset(num_sprites);
+
+    // write a temporary file then rename it, so that a pack mapped by a running game stays intact
+    char temporary[PACK_PATH_LENGTH + 8];
+    snprintf(temporary, sizeof(temporary), "%s.tmp", filename);
+
+    FILE *file = fopen(temporary, "wb");
+
+    if (!file) {
+        error("Can't create %s\n", temporary);
+    }
+
+    size_t written = fwrite(&header, sizeof(struct pack_header), 1, file);
+
+    for (int i = 0; i < num_sprites; i++) {
+        struct pack_entry entry;
+        struct stat info;
+
+        assert(strlen(paths[i]) < PACK_PATH_LENGTH);
+
+        if (stat(paths[i], &info) != 0) {
+            error("Can't stat image %s\n", paths[i]);
+        }
+
+        memset(&entry, 0, sizeof(struct pack_entry));
+        strcpy(entry.filename, paths[i]);
+        entry.size = (int64_t) info.st_size;
+        entry.mtime = (int64_t) info.st_mtime;
+        entry.x = rects[i].x;
+        entry.y = rects[i].y;
+        entry.w = rects[i].w;
+        entry.h = rects[i].h;
+
+        written += fwrite(&entry, sizeof(struct pack_entry), 1, file);
+    }
+
+    static const char padding[PACK_PIXELS_ALIGNMENT];
+    size_t padding_size = header.pixels_offset - sizeof(struct pack_header) - num_sprites * sizeof(struct pack_entry);
+
+    if (padding_size > 0) {
+        written += fwrite(padding, padding_size, 1, file);
+    } else {
+        written++;
+    }
+
+    // locking gives access to the raw pixels of a run-length encoded surface
+    if (SDL_LockSurface(atlas) != 0) {
+        error("Can't lock sprite atlas: %s\n", SDL_GetError());
+    }
+
+    for (int y = 0; y < atlas->h; y++) {
+        written += fwrite((char *) atlas->pixels + (size_t) y * atlas->pitch, header.pitch, 1, file);
+    }
+
+    SDL_UnlockSurface(atlas);
+
+    if (written != (size_t) (2 + num_sprites + atlas->h) || fclose(file) != 0) {
+        error("Can't write %s\n", temporary);
+    }
+
+    if (rename(temporary, filename) != 0) {
+        error("Can't rename %s to %s\n", temporary, filename);
+    }
+}
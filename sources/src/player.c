@@ -12,12 +12,15 @@
 struct player {
     int x; /**< X position of the player */
     int y; /**< Y position of the player */
+    int previous_x; /**< X position of the player before its last move */
+    int previous_y; /**< Y position of the player before its last move */
     enum direction direction; /**< Direction of the player */
     int num_bombs; /**< Number of bombs of the player */
     int range_bombs; /**< Range of the player's bombs */
     int num_lives; /**< Number of lives of the player */
     int num_keys; /**< Number of keys of the player */
     struct timer *timer_invincibility; /**< Invincibility timer of the player */
+    struct timer *timer_move; /**< Timer of the last move of the player, started with it */
 };
 
 struct player *player_new(int x, int y, int num_bombs) {
@@ -38,8 +41,11 @@ struct player *player_new(int x, int y, int num_bombs) {
     player->num_lives = 3;
     player->num_keys = 0;
     player->timer_invincibility = timer_new();
+    player->timer_move = timer_new();
     player->x = x;
     player->y = y;
+    player->previous_x = x;
+    player->previous_y = y;
 
     return player;
 }
@@ -47,21 +53,32 @@ struct player *player_new(int x, int y, int num_bombs) {
 void player_free(struct player *player) {
     assert(player);
     assert(player->timer_invincibility);
+    assert(player->timer_move);
 
     timer_free(player->timer_invincibility);
+    timer_free(player->timer_move);
     free(player);
 }
 
-void player_write(struct player *player, FILE *file) {
+void player_serialize(struct player *player, struct buffer *buffer) {
     assert(player);
-    assert(file);
-
-    fwrite(player, sizeof(struct player), 1, file);
-    timer_write(player->timer_invincibility, file);
+    assert(buffer);
+
+    buffer_write_int(buffer, player->x);
+    buffer_write_int(buffer, player->y);
+    buffer_write_int(buffer, player->previous_x);
+    buffer_write_int(buffer, player->previous_y);
+    buffer_write_int(buffer, player->direction);
+    buffer_write_int(buffer, player->num_bombs);
+    buffer_write_int(buffer, player->range_bombs);
+    buffer_write_int(buffer, player->num_lives);
+    buffer_write_int(buffer, player->num_keys);
+    timer_serialize(player->timer_invincibility, buffer);
+    timer_serialize(player->timer_move, buffer);
 }
 
-struct player *player_read(FILE *file) {
-    assert(file);
+struct player *player_deserialize(struct buffer *buffer) {
+    assert(buffer);
 
     struct player *player = malloc(sizeof(struct player));
 
@@ -70,13 +87,46 @@ struct player *player_read(FILE *file) {
         exit(EXIT_FAILURE);
     }
 
-    fread(player, sizeof(struct player), 1, file);
-
-    player->timer_invincibility = timer_read(file);
+    player->x = buffer_read_int(buffer);
+    player->y = buffer_read_int(buffer);
+    player->previous_x = buffer_read_int(buffer);
+    player->previous_y = buffer_read_int(buffer);
+    player->direction = (enum direction) buffer_read_int(buffer);
+    player->num_bombs = buffer_read_int(buffer);
+    player->range_bombs = buffer_read_int(buffer);
+    player->num_lives = buffer_read_int(buffer);
+    player->num_keys = buffer_read_int(buffer);
+    player->timer_invincibility = timer_deserialize(buffer);
+    player->timer_move = timer_deserialize(buffer);
 
     return player;
 }
 
+void player_checkpoint(struct player *player, struct buffer *buffer) {
+    assert(player);
+    assert(buffer);
+
+    buffer_write_bytes(buffer, player, sizeof(struct player));
+    timer_checkpoint(player->timer_invincibility, buffer);
+    timer_checkpoint(player->timer_move, buffer);
+}
+
+void player_rollback(struct player *player, struct buffer *buffer) {
+    assert(player);
+    assert(buffer);
+
+    struct timer *timer_invincibility = player->timer_invincibility;
+    struct timer *timer_move = player->timer_move;
+
+    // the timers copied are the ones of the player at the time of the checkpoint
+    buffer_read_bytes(buffer, player, sizeof(struct player));
+    player->timer_invincibility = timer_invincibility;
+    player->timer_move = timer_move;
+
+    timer_rollback(timer_invincibility, buffer);
+    timer_rollback(timer_move, buffer);
+}
+
 enum direction player_get_direction(struct player *player) {
     assert(player);
     return player->direction;
@@ -87,6 +137,11 @@ struct timer *player_get_timer_invincibility(struct player *player) {
     return player->timer_invincibility;
 }
 
+struct timer *player_get_timer_move(struct player *player) {
+    assert(player);
+    return player->timer_move;
+}
+
 void player_set_timer_invincibility(struct player *player, struct timer *timer_invincibility) {
     assert(player);
     assert(timer_invincibility);
@@ -213,11 +268,21 @@ void player_dec_num_keys(struct player *player) {
     }
 }
 
-void player_display(struct player *player, SDL_Surface *window, struct sprites *sprites) {
+void player_save_position(struct player *player) {
     assert(player);
-    assert(window);
 
-    window_display_image(window, sprites_get_player(sprites, player->direction), player->x * SIZE_BLOC, player->y * SIZE_BLOC);
+    player->previous_x = player->x;
+    player->previous_y = player->y;
+}
+
+int player_get_previous_x(struct player *player) {
+    assert(player);
+    return player->previous_x;
+}
+
+int player_get_previous_y(struct player *player) {
+    assert(player);
+    return player->previous_y;
 }
 
 void player_get_bonus(struct player *player, enum bonus_type bonus_type) {
@@ -244,7 +309,10 @@ void player_move(struct player *player, enum direction direction) {
     assert(player);
 
     player_set_direction(player, direction);
+    player_save_position(player);
 
     player_set_x(player, direction_get_x(direction, player_get_x(player), 1));
     player_set_y(player, direction_get_y(direction, player_get_y(player), 1));
+
+    timer_start(player->timer_move, DURATION_PLAYER_MOVE);
 }
@@ -1,7 +1,31 @@
 #include "../include/random.h"
 #include "../include/constant.h"
 #include <assert.h>
-#include <time.h>
+#include <stdlib.h>
+
+/**
+ * @brief State of the pseudo-random numbers, a xorshift generator, never 0.
+ */
+static Uint32 random_state = 1;
+
+void random_set_seed(Uint32 seed) {
+    // a xorshift generator stays at 0 forever
+    random_state = seed ? seed : 0x9e3779b9;
+}
+
+Uint32 random_get_state(void) {
+    return random_state;
+}
+
+int random_get_int(int max) {
+    assert(max > 0);
+
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+
+    return (int) (random_state % (Uint32) max);
+}
 
 void random_move_monster(struct map *map, struct monster_node *monster, struct player *player) {
     assert(map);
@@ -11,23 +35,19 @@ void random_move_monster(struct map *map, struct monster_node *monster, struct p
     timer_update(monster_node_get_timer(monster));
 
     if (timer_is_over(monster_node_get_timer(monster)) == 1) {
-        static int i = 0;
-
-        srand(time(NULL) + i++);
-
         int visited_directions[NUM_DIRECTIONS] = {0, 0, 0, 0};
         while (visited_directions[NORTH] != 1 || visited_directions[SOUTH] != 1 || visited_directions[EAST] != 1 || visited_directions[WEST] != 1) {
             enum direction directions[NUM_DIRECTIONS] = {NORTH, SOUTH, EAST, WEST};
-            enum direction direction = directions[rand() % NUM_DIRECTIONS];
+            enum direction direction = directions[random_get_int(NUM_DIRECTIONS)];
 
             if (visited_directions[direction] != 1) {
                 if (map_can_monster_move(map, player, monster, direction)) {
                     if (map_will_monster_meet_player(monster, player, direction)) {
-                        map_monster_meeting_player(monster, player, direction);
+                        map_monster_meeting_player(map, monster, player, direction);
                         break;
                     }
 
-                    monster_node_move(monster, direction);
+                    map_move_monster(map, monster, direction);
                     break;
                 }
 
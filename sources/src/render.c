@@ -0,0 +1,144 @@
+#include "../include/render.h"
+#include "../include/window.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Initial number of commands a render queue can hold.
+ */
+#define RENDER_QUEUE_CAPACITY 256
+
+/**
+ * @brief Structure representing a render queue.
+ */
+struct render_queue {
+    struct render_command *commands; /**< Commands of the frame */
+    int num_commands; /**< Number of commands */
+    int capacity; /**< Number of commands the array can hold */
+    int tile_size; /**< Size of a cell in pixels the coordinates are scaled to */
+    int scroll_x; /**< Distance the next commands are moved to the left by, in logical coordinates */
+    int scroll_y; /**< Distance the next commands are moved up by, in logical coordinates */
+};
+
+struct render_queue *render_queue_new(void) {
+    struct render_queue *queue = malloc(sizeof(struct render_queue));
+
+    if (!queue) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    queue->commands = malloc(RENDER_QUEUE_CAPACITY * sizeof(struct render_command));
+
+    if (!queue->commands) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    queue->num_commands = 0;
+    queue->capacity = RENDER_QUEUE_CAPACITY;
+    queue->tile_size = SIZE_BLOC;
+    queue->scroll_x = 0;
+    queue->scroll_y = 0;
+
+    return queue;
+}
+
+void render_queue_free(struct render_queue *queue) {
+    assert(queue);
+
+    free(queue->commands);
+    free(queue);
+}
+
+void render_queue_clear(struct render_queue *queue) {
+    assert(queue);
+    queue->num_commands = 0;
+}
+
+void render_queue_set_tile_size(struct render_queue *queue, int tile_size) {
+    assert(queue);
+    assert(tile_size > 0);
+
+    queue->tile_size = tile_size;
+}
+
+void render_queue_set_scroll(struct render_queue *queue, int x, int y) {
+    assert(queue);
+
+    queue->scroll_x = x;
+    queue->scroll_y = y;
+}
+
+void render_queue_push(struct render_queue *queue, struct sprite *sprite, int x, int y, enum render_layer layer) {
+    assert(queue);
+    assert(sprite);
+
+    if (queue->num_commands == queue->capacity) {
+        queue->capacity *= 2;
+        queue->commands = realloc(queue->commands, queue->capacity * sizeof(struct render_command));
+
+        if (!queue->commands) {
+            fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct render_command *command = &queue->commands[queue->num_commands];
+
+    command->sprite = *sprite;
+    // the scroll is scaled on its own, so that the cells stay the same size in pixels
+    command->x = (Sint16) (sprites_scale_length(x, queue->tile_size) - sprites_scale_length(queue->scroll_x, queue->tile_size));
+    command->y = (Sint16) (sprites_scale_length(y, queue->tile_size) - sprites_scale_length(queue->scroll_y, queue->tile_size));
+    command->layer = (Uint16) layer;
+    command->order = (Uint32) queue->num_commands;
+
+    queue->num_commands++;
+}
+
+static int compare_commands(const void *a, const void *b) {
+    const struct render_command *first = a;
+    const struct render_command *second = b;
+
+    if (first->layer != second->layer) {
+        return first->layer < second->layer ? -1 : 1;
+    }
+
+    // consecutive blits from the same surface keep its pixels in cache
+    if (first->sprite.surface != second->sprite.surface) {
+        return (uintptr_t) first->sprite.surface < (uintptr_t) second->sprite.surface ? -1 : 1;
+    }
+
+    // the push order breaks the ties, so that the sort is stable
+    return first->order < second->order ? -1 : 1;
+}
+
+void render_queue_sort(struct render_queue *queue) {
+    assert(queue);
+    qsort(queue->commands, queue->num_commands, sizeof(struct render_command), compare_commands);
+}
+
+void render_queue_execute(struct render_queue *queue, SDL_Surface *window) {
+    assert(queue);
+    assert(window);
+
+    render_queue_sort(queue);
+
+    for (int i = 0; i < queue->num_commands; i++) {
+        struct render_command *command = &queue->commands[i];
+        window_display_sprite(window, &command->sprite, command->x, command->y);
+    }
+}
+
+int render_queue_get_num_commands(struct render_queue *queue) {
+    assert(queue);
+    return queue->num_commands;
+}
+
+struct render_command *render_queue_get_commands(struct render_queue *queue) {
+    assert(queue);
+    return queue->commands;
+}
@@ -0,0 +1,477 @@
+#include "../include/replay.h"
+#include "../include/random.h"
+#include "../include/misc.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief Characters starting a replay file.
+ */
+#define REPLAY_MAGIC "BOMBRPLY"
+
+/**
+ * @brief Characters ending a replay file with an index of its keyframes.
+ */
+#define INDEX_MAGIC "KEYS"
+
+/**
+ * @brief Version of the replay format, changed with the format or with the game rules.
+ */
+#define REPLAY_VERSION 6
+
+/**
+ * @brief Number of bits of a record holding its action, the other bits hold the ticks since the previous record.
+ */
+#define ACTION_BITS 4
+
+/**
+ * @brief Action of the records holding a keyframe, after the actions of the game.
+ */
+#define KEYFRAME_RECORD ((1 << ACTION_BITS) - 1)
+
+/**
+ * @brief Structure describing a keyframe of a replay file.
+ */
+struct keyframe {
+    Uint32 tick; /**< Game tick after which the state was written */
+    Uint32 offset; /**< Offset of the keyframe record from the start of the file */
+    int num_inputs; /**< Number of inputs before the keyframe */
+};
+
+/**
+ * @brief Structure representing a replay being recorded or played back.
+ * Each record is a varint of the ticks since the previous record shifted by ACTION_BITS, or'ed with its action.
+ * A keyframe record is followed by the number of inputs before it, the size of the state and the state.
+ * The last record has no action and is followed by the hash of the final state. The index of the keyframes
+ * comes next, with its offset and INDEX_MAGIC in the last bytes of the file.
+ */
+struct replay {
+    FILE *file; /**< The replay file */
+    int is_playback; /**< Is the file played back rather than recorded ? */
+    Uint32 tick; /**< Game tick of the previous record, or of the next record while playing back */
+    enum action action; /**< Action of the next record while playing back, ACTION_NONE at the end */
+    int has_state_hash; /**< Does the playback have the final state of the recording ? */
+    Uint32 state_hash; /**< Final state of the recording */
+    int num_inputs; /**< Number of inputs recorded or played back */
+    long records_offset; /**< Offset of the first record from the start of the file */
+    struct keyframe *keyframes; /**< Keyframes recorded, or read from the index at the first seek */
+    int num_keyframes; /**< Number of keyframes */
+    int max_keyframes; /**< Number of keyframes the keyframes array can hold, 0 before the first seek */
+};
+
+static void write_varint(FILE *file, Uint32 value) {
+    assert(file);
+
+    // seven bits per byte, the high bit tells that more bytes follow
+    while (value >= 0x80) {
+        fputc((int) (value & 0x7f) | 0x80, file);
+        value >>= 7;
+    }
+
+    fputc((int) value, file);
+}
+
+static int read_varint(FILE *file, Uint32 *value) {
+    assert(file);
+    assert(value);
+
+    *value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        int byte = fgetc(file);
+
+        if (byte == EOF) {
+            return 0;
+        }
+
+        *value |= (Uint32) (byte & 0x7f) << shift;
+
+        if (!(byte & 0x80)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static struct replay *replay_new(FILE *file, int is_playback) {
+    assert(file);
+
+    struct replay *replay = malloc(sizeof(struct replay));
+
+    if (!replay) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(replay, 0, sizeof(struct replay));
+
+    replay->file = file;
+    replay->is_playback = is_playback;
+    replay->records_offset = ftell(file);
+
+    return replay;
+}
+
+static void add_keyframe(struct replay *replay, Uint32 tick, Uint32 offset, int num_inputs) {
+    assert(replay);
+
+    if (replay->num_keyframes == replay->max_keyframes) {
+        replay->max_keyframes = replay->max_keyframes ? 2 * replay->max_keyframes : 64;
+        replay->keyframes = realloc(replay->keyframes, replay->max_keyframes * sizeof(struct keyframe));
+
+        if (!replay->keyframes) {
+            fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    replay->keyframes[replay->num_keyframes].tick = tick;
+    replay->keyframes[replay->num_keyframes].offset = offset;
+    replay->keyframes[replay->num_keyframes].num_inputs = num_inputs;
+    replay->num_keyframes++;
+}
+
+struct replay *replay_new_recording(const char *filename, Uint32 level_hash) {
+    assert(filename);
+    assert(NUM_ACTIONS <= KEYFRAME_RECORD);
+
+    FILE *file = fopen(filename, "wb");
+
+    if (!file) {
+        error("Can't create replay file %s\n", filename);
+    }
+
+    Uint32 seed = (Uint32) time(NULL);
+
+    random_set_seed(seed);
+
+    fwrite(REPLAY_MAGIC, 1, strlen(REPLAY_MAGIC), file);
+    write_varint(file, REPLAY_VERSION);
+    write_varint(file, seed);
+    write_varint(file, level_hash);
+
+    return replay_new(file, 0);
+}
+
+static int skip_keyframe(FILE *file, Uint32 *num_inputs) {
+    assert(file);
+    assert(num_inputs);
+
+    Uint32 size;
+
+    return read_varint(file, num_inputs) && read_varint(file, &size) && fseek(file, (long) size, SEEK_CUR) == 0;
+}
+
+static void read_record(struct replay *replay) {
+    assert(replay);
+
+    Uint32 record, num_inputs;
+
+    // the keyframes are only read when seeking
+    do {
+        // a recording cut short, by a crash for instance, ends after its last input
+        if (!read_varint(replay->file, &record)) {
+            replay->action = ACTION_NONE;
+            return;
+        }
+
+        replay->tick += record >> ACTION_BITS;
+        replay->action = (enum action) (record & ((1 << ACTION_BITS) - 1));
+
+        if (replay->action == KEYFRAME_RECORD && !skip_keyframe(replay->file, &num_inputs)) {
+            replay->action = ACTION_NONE;
+            return;
+        }
+    } while (replay->action == KEYFRAME_RECORD);
+
+    if (replay->action >= NUM_ACTIONS) {
+        error("Corrupted replay file, unknown action %d\n", replay->action);
+    }
+
+    if (replay->action == ACTION_NONE) {
+        replay->has_state_hash = read_varint(replay->file, &replay->state_hash);
+    }
+}
+
+struct replay *replay_new_playback(const char *filename, Uint32 level_hash) {
+    assert(filename);
+
+    FILE *file = fopen(filename, "rb");
+
+    if (!file) {
+        error("Can't open replay file %s\n", filename);
+    }
+
+    char magic[sizeof(REPLAY_MAGIC) - 1];
+    Uint32 version, seed, recorded_level_hash;
+
+    if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, REPLAY_MAGIC, sizeof(magic)) != 0) {
+        error("%s isn't a replay file\n", filename);
+    }
+
+    if (!read_varint(file, &version) || version != REPLAY_VERSION) {
+        error("Replay file %s has version %u, this game plays version %d\n", filename, version, REPLAY_VERSION);
+    }
+
+    if (!read_varint(file, &seed) || !read_varint(file, &recorded_level_hash)) {
+        error("Corrupted replay file %s\n", filename);
+    }
+
+    if (recorded_level_hash != level_hash) {
+        error("Replay file %s was recorded on other levels\n", filename);
+    }
+
+    random_set_seed(seed);
+
+    struct replay *replay = replay_new(file, 1);
+
+    read_record(replay);
+
+    return replay;
+}
+
+static void write_index(struct replay *replay) {
+    assert(replay);
+
+    long index_offset = ftell(replay->file);
+    Uint32 tick = 0, offset = 0;
+
+    write_varint(replay->file, (Uint32) replay->num_keyframes);
+
+    // ticks and offsets grow, the differences take a byte or two
+    for (int i = 0; i < replay->num_keyframes; i++) {
+        write_varint(replay->file, replay->keyframes[i].tick - tick);
+        write_varint(replay->file, replay->keyframes[i].offset - offset);
+        write_varint(replay->file, (Uint32) replay->keyframes[i].num_inputs);
+
+        tick = replay->keyframes[i].tick;
+        offset = replay->keyframes[i].offset;
+    }
+
+    unsigned char trailer[4];
+
+    for (int i = 0; i < 4; i++) {
+        trailer[i] = (unsigned char) ((Uint32) index_offset >> (8 * i));
+    }
+
+    fwrite(trailer, 1, sizeof(trailer), replay->file);
+    fwrite(INDEX_MAGIC, 1, strlen(INDEX_MAGIC), replay->file);
+}
+
+static int read_index(struct replay *replay) {
+    assert(replay);
+
+    unsigned char trailer[4 + sizeof(INDEX_MAGIC) - 1];
+
+    if (fseek(replay->file, -(long) sizeof(trailer), SEEK_END) != 0 || fread(trailer, 1, sizeof(trailer), replay->file) != sizeof(trailer) || memcmp(trailer + 4, INDEX_MAGIC, sizeof(INDEX_MAGIC) - 1) != 0) {
+        return 0;
+    }
+
+    Uint32 index_offset = 0;
+
+    for (int i = 0; i < 4; i++) {
+        index_offset |= (Uint32) trailer[i] << (8 * i);
+    }
+
+    Uint32 num_keyframes, tick = 0, offset = 0, tick_step, offset_step, num_inputs;
+
+    if (fseek(replay->file, (long) index_offset, SEEK_SET) != 0 || !read_varint(replay->file, &num_keyframes)) {
+        return 0;
+    }
+
+    for (Uint32 i = 0; i < num_keyframes; i++) {
+        if (!read_varint(replay->file, &tick_step) || !read_varint(replay->file, &offset_step) || !read_varint(replay->file, &num_inputs)) {
+            replay->num_keyframes = 0;
+            return 0;
+        }
+
+        tick += tick_step;
+        offset += offset_step;
+        add_keyframe(replay, tick, offset, (int) num_inputs);
+    }
+
+    return 1;
+}
+
+static void scan_keyframes(struct replay *replay) {
+    assert(replay);
+
+    Uint32 tick = 0, record, num_inputs, size;
+
+    fseek(replay->file, 0, SEEK_END);
+
+    long file_size = ftell(replay->file);
+
+    fseek(replay->file, replay->records_offset, SEEK_SET);
+
+    // without an index, every record is read up to the end of the recording
+    for (long offset = ftell(replay->file); read_varint(replay->file, &record); offset = ftell(replay->file)) {
+        tick += record >> ACTION_BITS;
+
+        int action = (int) (record & ((1 << ACTION_BITS) - 1));
+
+        if (action == ACTION_NONE) {
+            break;
+        }
+
+        if (action != KEYFRAME_RECORD) {
+            continue;
+        }
+
+        // a keyframe cut short is left out
+        if (!read_varint(replay->file, &num_inputs) || !read_varint(replay->file, &size) || ftell(replay->file) + (long) size > file_size) {
+            break;
+        }
+
+        fseek(replay->file, (long) size, SEEK_CUR);
+        add_keyframe(replay, tick, (Uint32) offset, (int) num_inputs);
+    }
+}
+
+void replay_free(struct replay *replay, Uint32 tick, Uint32 state_hash) {
+    assert(replay);
+
+    if (!replay->is_playback) {
+        assert(tick >= replay->tick);
+
+        write_varint(replay->file, (tick - replay->tick) << ACTION_BITS | ACTION_NONE);
+        write_varint(replay->file, state_hash);
+        write_index(replay);
+
+        long size = ftell(replay->file);
+
+        printf("Replay: %d inputs and %d keyframes over %u ticks, %ld bytes\n", replay->num_inputs, replay->num_keyframes, tick, size);
+    } else if (!replay->has_state_hash) {
+        printf("Replay: %d inputs over %u ticks, the recording stops without its final state\n", replay->num_inputs, tick);
+    } else if (replay->state_hash == state_hash && replay->tick == tick) {
+        printf("Replay: %d inputs over %u ticks, same final state as the recording\n", replay->num_inputs, tick);
+    } else {
+        printf("Replay: %d inputs over %u ticks, the final state differs from the recording, which ended on tick %u\n", replay->num_inputs, tick, replay->tick);
+    }
+
+    fclose(replay->file);
+    free(replay->keyframes);
+    free(replay);
+}
+
+int replay_is_playback(struct replay *replay) {
+    assert(replay);
+
+    return replay->is_playback;
+}
+
+void replay_record(struct replay *replay, Uint32 tick, enum action action) {
+    assert(replay);
+    assert(!replay->is_playback);
+    assert(tick >= replay->tick);
+    assert(action != ACTION_NONE);
+
+    write_varint(replay->file, (tick - replay->tick) << ACTION_BITS | action);
+
+    // the inputs recorded before a crash are kept, a write costs less than a frame
+    fflush(replay->file);
+
+    replay->tick = tick;
+    replay->num_inputs++;
+}
+
+void replay_record_keyframe(struct replay *replay, Uint32 tick, struct buffer *state) {
+    assert(replay);
+    assert(!replay->is_playback);
+    assert(tick >= replay->tick);
+    assert(state);
+
+    add_keyframe(replay, tick, (Uint32) ftell(replay->file), replay->num_inputs);
+
+    write_varint(replay->file, (tick - replay->tick) << ACTION_BITS | KEYFRAME_RECORD);
+    write_varint(replay->file, (Uint32) replay->num_inputs);
+    write_varint(replay->file, (Uint32) buffer_get_size(state));
+    fwrite(buffer_get_data(state), 1, buffer_get_size(state), replay->file);
+    fflush(replay->file);
+
+    replay->tick = tick;
+}
+
+Uint32 replay_seek(struct replay *replay, Uint32 tick, struct buffer *state) {
+    assert(replay);
+    assert(replay->is_playback);
+    assert(state);
+
+    if (replay->max_keyframes == 0 && !read_index(replay)) {
+        scan_keyframes(replay);
+    }
+
+    // the latest keyframe at or before the tick, the keyframes being sorted by tick
+    int first = 0, last = replay->num_keyframes - 1;
+
+    while (first < last) {
+        int middle = (first + last + 1) / 2;
+
+        if (replay->keyframes[middle].tick <= tick) {
+            first = middle;
+        } else {
+            last = middle - 1;
+        }
+    }
+
+    if (replay->num_keyframes == 0 || replay->keyframes[first].tick > tick) {
+        error("No keyframe in the replay file before tick %u\n", tick);
+    }
+
+    struct keyframe *keyframe = &replay->keyframes[first];
+    Uint32 record, num_inputs, size;
+
+    fseek(replay->file, (long) keyframe->offset, SEEK_SET);
+
+    if (!read_varint(replay->file, &record) || (record & ((1 << ACTION_BITS) - 1)) != KEYFRAME_RECORD || !read_varint(replay->file, &num_inputs) || !read_varint(replay->file, &size)) {
+        error("Corrupted replay file, no keyframe at offset %u\n", keyframe->offset);
+    }
+
+    buffer_clear(state);
+
+    unsigned char bytes[1024];
+
+    while (size > 0) {
+        size_t length = size < sizeof(bytes) ? size : sizeof(bytes);
+
+        if (fread(bytes, 1, length, replay->file) != length) {
+            error("Corrupted replay file, keyframe of tick %u cut short\n", keyframe->tick);
+        }
+
+        buffer_write_bytes(state, bytes, length);
+        size -= (Uint32) length;
+    }
+
+    // the records following the keyframe count their ticks from it
+    replay->tick = keyframe->tick;
+    replay->num_inputs = keyframe->num_inputs;
+    read_record(replay);
+
+    return keyframe->tick;
+}
+
+enum action replay_play(struct replay *replay, Uint32 tick) {
+    assert(replay);
+    assert(replay->is_playback);
+
+    if (replay->action == ACTION_NONE || replay->tick != tick) {
+        return ACTION_NONE;
+    }
+
+    enum action action = replay->action;
+
+    read_record(replay);
+    replay->num_inputs++;
+
+    return action;
+}
+
+int replay_is_over(struct replay *replay, Uint32 tick) {
+    assert(replay);
+    assert(replay->is_playback);
+
+    return replay->action == ACTION_NONE && tick > replay->tick;
+}
@@ -0,0 +1,207 @@
+#include "../include/scene.h"
+#include "../include/window.h"
+#include "../include/misc.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing a scene.
+ */
+struct scene {
+    SDL_Surface **backgrounds; /**< Pre-composited scenery cells of each level, NULL until its first display */
+    int num_levels; /**< Number of levels backgrounds can hold */
+};
+
+struct scene *scene_new(void) {
+    struct scene *scene = malloc(sizeof(struct scene));
+
+    if (!scene) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(scene, 0, sizeof(struct scene));
+
+    return scene;
+}
+
+void scene_free(struct scene *scene) {
+    assert(scene);
+
+    for (int i = 0; i < scene->num_levels; i++) {
+        if (scene->backgrounds[i]) {
+            SDL_FreeSurface(scene->backgrounds[i]);
+        }
+    }
+
+    free(scene->backgrounds);
+    free(scene);
+}
+
+static SDL_Surface *build_background(const struct snapshot *snapshot, struct sprites *sprites) {
+    assert(snapshot);
+    assert(sprites);
+    assert(SDL_GetVideoSurface());
+
+    SDL_PixelFormat *format = SDL_GetVideoSurface()->format;
+    int tile_size = sprites_get_tile_size(sprites);
+
+    SDL_Surface *background = SDL_CreateRGBSurface(SDL_SWSURFACE, snapshot->width * tile_size, snapshot->height * tile_size, format->BitsPerPixel, format->Rmask, format->Gmask, format->Bmask, format->Amask);
+
+    if (!background) {
+        error("Can't create map background: %s\n", SDL_GetError());
+    }
+
+    window_clear(background);
+
+    // scenery cells never change once the level is loaded
+    for (int i = 0; i < snapshot->width; i++) {
+        for (int j = 0; j < snapshot->height; j++) {
+            unsigned char type = snapshot_get_cell_value(snapshot, i, j);
+
+            if ((type & 0xf0) == CELL_SCENERY) {
+                window_display_sprite(background, sprites_get_scenery(sprites, (enum scenery_type) (type & 0x0f)), i * tile_size, j * tile_size);
+            }
+        }
+    }
+
+    return background;
+}
+
+static SDL_Surface *get_background(struct scene *scene, const struct snapshot *snapshot, struct sprites *sprites) {
+    assert(scene);
+    assert(snapshot);
+
+    if (snapshot->level >= scene->num_levels) {
+        int num_levels = snapshot->level + 1;
+
+        scene->backgrounds = realloc(scene->backgrounds, num_levels * sizeof(SDL_Surface *));
+
+        if (!scene->backgrounds) {
+            fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+            exit(EXIT_FAILURE);
+        }
+
+        memset(scene->backgrounds + scene->num_levels, 0, (num_levels - scene->num_levels) * sizeof(SDL_Surface *));
+        scene->num_levels = num_levels;
+    }
+
+    SDL_Surface **background = &scene->backgrounds[snapshot->level];
+
+    // the background is drawn again when the tile size changes
+    if (*background && (*background)->w != snapshot->width * sprites_get_tile_size(sprites)) {
+        SDL_FreeSurface(*background);
+        *background = NULL;
+    }
+
+    if (!*background) {
+        *background = build_background(snapshot, sprites);
+    }
+
+    return *background;
+}
+
+static void display_entity(struct render_queue *queue, struct sprite *sprite, struct camera *camera, const struct snapshot_entity *entity, double alpha) {
+    assert(queue);
+    assert(camera);
+    assert(entity);
+
+    // an entity sliding into or out of the view is drawn on both sides of the edge
+    if (!camera_is_visible(camera, entity->x, entity->y) && !camera_is_visible(camera, entity->previous_x, entity->previous_y)) {
+        return;
+    }
+
+    int x = camera_project_x(camera, snapshot_entity_get_x(entity, alpha));
+    int y = camera_project_y(camera, snapshot_entity_get_y(entity, alpha));
+
+    render_queue_push(queue, sprite, x, y, LAYER_ENTITIES);
+}
+
+void scene_display(struct scene *scene, struct render_queue *queue, struct sprites *sprites, struct camera *camera, const struct snapshot *snapshot, double alpha) {
+    assert(scene);
+    assert(queue);
+    assert(sprites);
+    assert(camera);
+    assert(snapshot);
+
+    int tile_size = sprites_get_tile_size(sprites);
+    int first_x = camera_get_x(camera);
+    int first_y = camera_get_y(camera);
+    int last_x = first_x + camera_get_width(camera) + (camera_get_scroll_x(camera) > 0 ? 1 : 0);
+    int last_y = first_y + camera_get_height(camera) + (camera_get_scroll_y(camera) > 0 ? 1 : 0);
+
+    assert(last_x <= snapshot->width && last_y <= snapshot->height);
+
+    // the map is drawn scrolled like the camera, what follows it isn't
+    render_queue_set_scroll(queue, camera_get_scroll_x(camera), camera_get_scroll_y(camera));
+
+    // only the visible part of the background is copied, the row scrolled under the banner is hidden by it
+    struct sprite visible_background;
+
+    visible_background.surface = get_background(scene, snapshot, sprites);
+    visible_background.rect.x = (Sint16) (first_x * tile_size);
+    visible_background.rect.y = (Sint16) (first_y * tile_size);
+    visible_background.rect.w = (Uint16) ((last_x - first_x) * tile_size);
+    visible_background.rect.h = (Uint16) ((last_y - first_y) * tile_size);
+
+    render_queue_push(queue, &visible_background, 0, 0, LAYER_BACKGROUND);
+
+    for (int i = first_x; i < last_x; i++) {
+        for (int j = first_y; j < last_y; j++) {
+            int x = (i - first_x) * SIZE_BLOC;
+            int y = (j - first_y) * SIZE_BLOC;
+
+            unsigned char type = snapshot_get_cell_value(snapshot, i, j);
+
+            switch ((enum cell_type) (type & 0xf0)) {
+                case CELL_BOX:
+                    render_queue_push(queue, sprites_get_box(sprites), x, y, LAYER_CELLS);
+                    break;
+
+                case CELL_BONUS:
+                    render_queue_push(queue, sprites_get_bonus(sprites, (enum bonus_type) (type & 0x0f)), x, y, LAYER_CELLS);
+                    break;
+
+                case CELL_KEY:
+                    render_queue_push(queue, sprites_get_key(sprites), x, y, LAYER_CELLS);
+                    break;
+
+                case CELL_DOOR:
+                    render_queue_push(queue, sprites_get_door(sprites, (enum door_status) (type & 0x01)), x, y, LAYER_CELLS);
+                    break;
+
+                default:
+                    break;
+            }
+
+            enum bomb_state bomb = snapshot_get_bomb_sprite(snapshot, i, j);
+
+            if (bomb != DONE) {
+                render_queue_push(queue, sprites_get_bomb(sprites, bomb), x, y, LAYER_CELLS);
+            }
+        }
+    }
+
+    // a monster moves one cell at a time, the ones sliding into the view stand just around it
+    int around_first_x = first_x > 0 ? first_x - 1 : 0;
+    int around_first_y = first_y > 0 ? first_y - 1 : 0;
+    int around_last_x = last_x < snapshot->width ? last_x + 1 : last_x;
+    int around_last_y = last_y < snapshot->height ? last_y + 1 : last_y;
+
+    // the player is drawn over the monsters it crosses
+    for (int j = around_first_y; j < around_last_y; j++) {
+        for (int i = around_first_x; i < around_last_x; i++) {
+            const struct snapshot_entity *monster = snapshot_get_monster(snapshot, i, j);
+
+            if (monster) {
+                display_entity(queue, sprites_get_monster(sprites, monster->direction), camera, monster, alpha);
+            }
+        }
+    }
+
+    display_entity(queue, sprites_get_player(sprites, snapshot->player.direction), camera, &snapshot->player, alpha);
+
+    render_queue_set_scroll(queue, 0, 0);
+}
@@ -0,0 +1,282 @@
+#include "../include/backend.h"
+#include "../include/game.h"
+#include "../include/map.h"
+#include "../include/scene.h"
+#include "../include/banner.h"
+#include "../include/input_ring.h"
+#include "../include/window.h"
+#include "../include/compositor.h"
+#include "../include/misc.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing the state of the SDL backend.
+ */
+struct sdl_backend {
+    struct sprites *sprites; /**< Sprites of the game */
+    SDL_Surface *window; /**< The window containing the game */
+    struct camera *camera; /**< Camera following the player on the current map */
+    struct render_queue *render_queue; /**< Sprites to draw in the current frame */
+    struct scene *scene; /**< Map, bombs, monsters and player of the snapshots */
+    struct banner *banner; /**< Banner below the map */
+    struct compositor *compositor; /**< Threads drawing the frames */
+    struct input_ring *inputs; /**< Commands read from the events, waiting for the game */
+    int is_closed; /**< Was the window closed ? Kept apart from the ring, so that quitting is never dropped */
+    Uint64 close_time; /**< Time the window was closed, set before is_closed */
+};
+
+static int get_window_width(int map_width, int tile_size) {
+    // the window fits the map, up to the size of the viewport
+    int width = map_width < VIEWPORT_WIDTH ? map_width : VIEWPORT_WIDTH;
+
+    return sprites_scale_length(SIZE_BLOC * width, tile_size);
+}
+
+static int get_window_height(int map_height, int tile_size) {
+    int height = map_height < VIEWPORT_HEIGHT ? map_height : VIEWPORT_HEIGHT;
+
+    return sprites_scale_length(SIZE_BLOC * height + BANNER_HEIGHT + LINE_HEIGHT, tile_size);
+}
+
+static int get_fitting_tile_size(int map_width, int map_height) {
+    // before the video mode is set, the current mode is the one of the desktop
+    const SDL_VideoInfo *info = SDL_GetVideoInfo();
+    int tile_size = SIZE_BLOC;
+
+    if (!info || info->current_w <= 0 || info->current_h <= 0) {
+        return tile_size;
+    }
+
+    while (tile_size > MIN_TILE_SIZE && (get_window_width(map_width, tile_size) > info->current_w || get_window_height(map_height, tile_size) > info->current_h)) {
+        tile_size -= TILE_SIZE_STEP;
+    }
+
+    return tile_size;
+}
+
+static int get_num_compositor_threads(void) {
+    int num_threads = get_num_processors();
+
+    return num_threads < MAX_COMPOSITOR_THREADS ? num_threads : MAX_COMPOSITOR_THREADS;
+}
+
+static void set_tile_size(struct sdl_backend *backend, int tile_size) {
+    assert(backend);
+    assert(tile_size >= MIN_TILE_SIZE && tile_size <= MAX_TILE_SIZE);
+
+    // only the scaled sprites and the backgrounds are rebuilt, the window follows on the next frame
+    sprites_set_tile_size(backend->sprites, tile_size);
+    render_queue_set_tile_size(backend->render_queue, tile_size);
+}
+
+static void zoom(struct sdl_backend *backend, int step) {
+    assert(backend);
+
+    int tile_size = sprites_get_tile_size(backend->sprites) + step;
+
+    if (tile_size >= MIN_TILE_SIZE && tile_size <= MAX_TILE_SIZE) {
+        set_tile_size(backend, tile_size);
+    }
+}
+
+static void *sdl_open(struct game *game, const char *argument) {
+    assert(game);
+
+    struct sdl_backend *backend = malloc(sizeof(struct sdl_backend));
+
+    if (!backend) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(backend, 0, sizeof(struct sdl_backend));
+
+    struct map *map = game_get_current_map(game);
+    int tile_size = argument ? atoi(argument) : get_fitting_tile_size(map_get_width(map), map_get_height(map));
+
+    if (tile_size < MIN_TILE_SIZE || tile_size > MAX_TILE_SIZE) {
+        error("The tile size must be between %d and %d pixels\n", MIN_TILE_SIZE, MAX_TILE_SIZE);
+    }
+
+    backend->window = window_create(get_window_width(map_get_width(map), tile_size), get_window_height(map_get_height(map), tile_size));
+    backend->camera = camera_new(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    backend->render_queue = render_queue_new();
+    backend->scene = scene_new();
+    backend->banner = banner_new();
+    backend->compositor = compositor_new(get_num_compositor_threads());
+    backend->inputs = input_ring_new();
+    backend->sprites = sprites_new();
+    set_tile_size(backend, tile_size);
+
+    SDL_EnableKeyRepeat(SDL_DEFAULT_REPEAT_DELAY, SDL_DEFAULT_REPEAT_INTERVAL);
+
+    return backend;
+}
+
+static void sdl_close(void *data) {
+    struct sdl_backend *backend = data;
+
+    assert(backend);
+
+    sprites_free(backend->sprites);
+    camera_free(backend->camera);
+    render_queue_free(backend->render_queue);
+    scene_free(backend->scene);
+    banner_free(backend->banner);
+    compositor_free(backend->compositor);
+    input_ring_free(backend->inputs);
+    // the window is the video surface, released by SDL_Quit
+    free(backend);
+}
+
+static void sdl_display(void *data, const struct snapshot *snapshot, double alpha) {
+    struct sdl_backend *backend = data;
+
+    assert(backend);
+    assert(snapshot);
+
+    int tile_size = sprites_get_tile_size(backend->sprites);
+
+    // the window and the backgrounds of the maps are kept, the video mode only changes with the window size
+    backend->window = window_resize(backend->window, get_window_width(snapshot->width, tile_size), get_window_height(snapshot->height, tile_size));
+
+    // the camera slides along with the player
+    camera_follow(backend->camera, snapshot->width, snapshot->height, snapshot_entity_get_x(&snapshot->player, alpha), snapshot_entity_get_y(&snapshot->player, alpha));
+
+    render_queue_clear(backend->render_queue);
+
+    scene_display(backend->scene, backend->render_queue, backend->sprites, backend->camera, snapshot, alpha);
+    banner_display(backend->banner, backend->render_queue, backend->sprites, backend->camera, snapshot);
+
+    compositor_draw(backend->compositor, backend->render_queue, backend->window);
+
+    window_refresh(backend->window);
+}
+
+static enum action get_key_action(SDL_keysym *keysym) {
+    assert(keysym);
+
+    switch (keysym->sym) {
+
+        // case ctrl + s
+        case SDLK_s:
+            return keysym->mod & KMOD_CTRL ? ACTION_SAVE : ACTION_NONE;
+
+        case SDLK_UP:
+            return ACTION_NORTH;
+
+        case SDLK_DOWN:
+            return ACTION_SOUTH;
+
+        case SDLK_RIGHT:
+            return ACTION_EAST;
+
+        case SDLK_LEFT:
+            return ACTION_WEST;
+
+        case SDLK_SPACE:
+            return ACTION_BOMB;
+
+        case SDLK_p:
+            return ACTION_PAUSE;
+
+        case SDLK_RETURN:
+            return ACTION_OPEN;
+
+        case SDLK_b:
+            return ACTION_BACK;
+
+        case SDLK_f:
+            return ACTION_FORWARD;
+
+        default:
+            return ACTION_NONE;
+    }
+}
+
+static void sdl_pump(void *data) {
+    struct sdl_backend *backend = data;
+
+    assert(backend);
+
+    SDL_Event event;
+    struct input_event input;
+
+    // the events are only read from the thread of the window, the game gets their commands through the ring
+    while (SDL_PollEvent(&event)) {
+
+        // SDL 1.2 events aren't timestamped, the latencies start when the events are read
+        input.time = get_monotonic_time();
+
+        if (event.type == SDL_QUIT && !backend->is_closed) {
+            backend->close_time = input.time;
+            __atomic_store_n(&backend->is_closed, 1, __ATOMIC_RELEASE);
+        }
+
+        if (event.type != SDL_KEYDOWN) {
+            continue;
+        }
+
+        input.action = get_key_action(&event.key.keysym);
+
+        if (input.action != ACTION_NONE) {
+            input_ring_push(backend->inputs, &input);
+            continue;
+        }
+
+        switch (event.key.keysym.sym) {
+
+            // zooming only changes the display, the game doesn't see it
+            case SDLK_PLUS:
+            case SDLK_EQUALS:
+            case SDLK_KP_PLUS:
+                zoom(backend, TILE_SIZE_STEP);
+                break;
+
+            case SDLK_MINUS:
+            case SDLK_KP_MINUS:
+                zoom(backend, -TILE_SIZE_STEP);
+                break;
+
+            default:
+                break;
+        }
+    }
+}
+
+static enum action sdl_poll(void *data, Uint64 *time) {
+    struct sdl_backend *backend = data;
+
+    assert(backend);
+    assert(time);
+
+    struct input_event input;
+
+    // the game quits once the commands read before the window was closed are applied
+    if (!input_ring_pop(backend->inputs, &input)) {
+        if (!__atomic_load_n(&backend->is_closed, __ATOMIC_ACQUIRE)) {
+            return ACTION_NONE;
+        }
+
+        *time = backend->close_time;
+
+        return ACTION_QUIT;
+    }
+
+    *time = input.time;
+
+    return input.action;
+}
+
+const struct backend sdl_backend = {
+    SDL_INIT_EVERYTHING,
+    DEFAULT_RENDER_FPS,
+    sdl_open,
+    sdl_close,
+    sdl_display,
+    sdl_pump,
+    sdl_poll
+};
@@ -0,0 +1,96 @@
+#include "../include/simulation.h"
+#include "../include/misc.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Structure representing the game running on a thread of its own.
+ */
+struct simulation {
+    struct game *game; /**< The game, only used by the thread once started */
+    struct snapshot_buffer *snapshots; /**< Snapshots published by the thread */
+    SDL_Thread *thread; /**< Thread running the game ticks */
+    int is_over; /**< Is the game over ? Set atomically by the thread */
+};
+
+static int simulation_run(void *data) {
+    struct simulation *simulation = data;
+
+    assert(simulation);
+
+    Uint32 tick_duration = 1000 / DEFAULT_GAME_FPS;
+    Uint32 next_tick = SDL_GetTicks();
+    int done = 0;
+
+    while (!done) {
+        done = game_update(simulation->game);
+
+        snapshot_capture(snapshot_buffer_get_back(simulation->snapshots), simulation->game);
+        snapshot_buffer_publish(simulation->snapshots);
+
+        next_tick += tick_duration;
+
+        Uint32 ticks = SDL_GetTicks();
+
+        if ((Sint32) (next_tick - ticks) > 0) {
+            SDL_Delay(next_tick - ticks);
+        } else if (ticks - next_tick > MAX_TICKS_PER_FRAME * tick_duration) {
+            // after a stall, the game catches up a few ticks then resumes from there
+            next_tick = ticks;
+        }
+    }
+
+    __atomic_store_n(&simulation->is_over, 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+struct simulation *simulation_new(struct game *game) {
+    assert(game);
+
+    struct simulation *simulation = malloc(sizeof(struct simulation));
+
+    if (!simulation) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(simulation, 0, sizeof(struct simulation));
+
+    simulation->game = game;
+    simulation->snapshots = snapshot_buffer_new();
+
+    // the display has a snapshot to draw before the first tick
+    snapshot_capture(snapshot_buffer_get_back(simulation->snapshots), game);
+    snapshot_buffer_publish(simulation->snapshots);
+
+    simulation->thread = SDL_CreateThread(simulation_run, simulation);
+
+    if (!simulation->thread) {
+        error("Can't create simulation thread: %s\n", SDL_GetError());
+    }
+
+    return simulation;
+}
+
+void simulation_free(struct simulation *simulation) {
+    assert(simulation);
+
+    SDL_WaitThread(simulation->thread, NULL);
+    snapshot_buffer_free(simulation->snapshots);
+    free(simulation);
+}
+
+int simulation_is_over(struct simulation *simulation) {
+    assert(simulation);
+
+    return __atomic_load_n(&simulation->is_over, __ATOMIC_ACQUIRE);
+}
+
+const struct snapshot *simulation_get_snapshot(struct simulation *simulation) {
+    assert(simulation);
+
+    return snapshot_buffer_get_latest(simulation->snapshots);
+}
@@ -0,0 +1,255 @@
+#include "../include/snapshot.h"
+#include "../include/game.h"
+#include "../include/map.h"
+#include "../include/timer.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Bit of the middle index of a triple buffer, set when the middle snapshot wasn't read yet.
+ */
+#define FRESH 4
+
+/**
+ * @brief Mask of the index of a snapshot in the middle index of a triple buffer.
+ */
+#define INDEX_MASK 3
+
+/**
+ * @brief Structure representing a triple buffer of snapshots.
+ */
+struct snapshot_buffer {
+    struct snapshot *snapshots[3]; /**< The three snapshots */
+    int back; /**< Index of the snapshot written by the game */
+    int front; /**< Index of the snapshot read by the display */
+    int middle; /**< Index of the latest snapshot published, with FRESH if it wasn't read yet, swapped atomically */
+};
+
+struct snapshot *snapshot_new(void) {
+    struct snapshot *snapshot = malloc(sizeof(struct snapshot));
+
+    if (!snapshot) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(snapshot, 0, sizeof(struct snapshot));
+
+    return snapshot;
+}
+
+void snapshot_free(struct snapshot *snapshot) {
+    assert(snapshot);
+
+    free(snapshot->grid);
+    free(snapshot->bomb_sprites);
+    free(snapshot->monster_cells);
+    free(snapshot->monsters);
+    free(snapshot);
+}
+
+static void capture_entity(struct snapshot_entity *entity, int x, int y, int previous_x, int previous_y, enum direction direction, struct timer *timer_move) {
+    assert(entity);
+    assert(timer_move);
+
+    entity->x = x;
+    entity->y = y;
+    entity->previous_x = previous_x;
+    entity->previous_y = previous_y;
+    entity->direction = direction;
+
+    int duration = timer_get_duration(timer_move);
+
+    // each entity slides over the duration of its own moves, whatever the length of the game ticks
+    if (duration > 0) {
+        entity->progress = (double) timer_get_elapsed(timer_move) / duration;
+        entity->speed = (double) (1000 / DEFAULT_GAME_FPS) / duration;
+    } else {
+        entity->progress = 1;
+        entity->speed = 0;
+    }
+
+    if (entity->progress > 1) {
+        entity->progress = 1;
+    }
+}
+
+static double interpolate(const struct snapshot_entity *entity, int previous, int current, double alpha) {
+    assert(entity);
+    assert(alpha >= 0 && alpha <= 1);
+
+    double progress = entity->progress + entity->speed * alpha;
+
+    return previous + (current - previous) * (progress < 1 ? progress : 1);
+}
+
+double snapshot_entity_get_x(const struct snapshot_entity *entity, double alpha) {
+    assert(entity);
+    return interpolate(entity, entity->previous_x, entity->x, alpha);
+}
+
+double snapshot_entity_get_y(const struct snapshot_entity *entity, double alpha) {
+    assert(entity);
+    return interpolate(entity, entity->previous_y, entity->y, alpha);
+}
+
+static void capture_map(struct snapshot *snapshot, struct map *map) {
+    assert(snapshot);
+    assert(map);
+
+    snapshot->width = map_get_width(map);
+    snapshot->height = map_get_height(map);
+
+    int num_cells = snapshot->width * snapshot->height;
+
+    // the snapshots only grow, up to the largest map
+    if (num_cells > snapshot->num_cells) {
+        free(snapshot->grid);
+        free(snapshot->bomb_sprites);
+        free(snapshot->monster_cells);
+
+        snapshot->grid = malloc(num_cells);
+        snapshot->bomb_sprites = malloc(num_cells);
+        snapshot->monster_cells = malloc(num_cells * sizeof(int));
+
+        if (!snapshot->grid || !snapshot->bomb_sprites || !snapshot->monster_cells) {
+            fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+            exit(EXIT_FAILURE);
+        }
+
+        snapshot->num_cells = num_cells;
+    }
+
+    memcpy(snapshot->grid, map_get_grid(map), num_cells);
+
+    map_build_bomb_sprites(map);
+
+    for (int j = 0; j < snapshot->height; j++) {
+        for (int i = 0; i < snapshot->width; i++) {
+            snapshot->bomb_sprites[i + j * snapshot->width] = (unsigned char) (map_get_bomb_sprite(map, i, j) + 1);
+        }
+    }
+
+    snapshot->num_monsters = 0;
+
+    // the display looks the monsters up by cell, like the map does
+    memset(snapshot->monster_cells, 0, num_cells * sizeof(int));
+
+    for (struct monster_node *monster = map_get_monster_head(map); monster != NULL; monster = monster_node_get_next(monster)) {
+
+        if (snapshot->num_monsters == snapshot->max_monsters) {
+            snapshot->max_monsters = snapshot->max_monsters ? 2 * snapshot->max_monsters : 8;
+            snapshot->monsters = realloc(snapshot->monsters, snapshot->max_monsters * sizeof(struct snapshot_entity));
+
+            if (!snapshot->monsters) {
+                fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        capture_entity(&snapshot->monsters[snapshot->num_monsters], monster_node_get_x(monster), monster_node_get_y(monster), monster_node_get_previous_x(monster), monster_node_get_previous_y(monster), monster_node_get_direction(monster), monster_node_get_timer(monster));
+        snapshot->num_monsters++;
+        snapshot->monster_cells[monster_node_get_x(monster) + monster_node_get_y(monster) * snapshot->width] = snapshot->num_monsters;
+    }
+}
+
+void snapshot_capture(struct snapshot *snapshot, struct game *game) {
+    assert(snapshot);
+    assert(game);
+
+    struct player *player = game_get_player(game);
+
+    snapshot->time = SDL_GetTicks();
+    snapshot->level = game_get_current_level(game);
+
+    capture_map(snapshot, game_get_current_map(game));
+    capture_entity(&snapshot->player, player_get_x(player), player_get_y(player), player_get_previous_x(player), player_get_previous_y(player), player_get_direction(player), player_get_timer_move(player));
+
+    snapshot->num_lives = player_get_num_lives(player);
+    snapshot->num_bombs = player_get_num_bomb(player);
+    snapshot->range_bombs = player_get_range_bombs(player);
+    snapshot->num_keys = player_get_num_keys(player);
+    snapshot->num_inputs = game_get_num_applied_inputs(game);
+}
+
+unsigned char snapshot_get_cell_value(const struct snapshot *snapshot, int x, int y) {
+    assert(snapshot);
+    assert(x >= 0 && x < snapshot->width && y >= 0 && y < snapshot->height);
+
+    return snapshot->grid[x + y * snapshot->width];
+}
+
+enum bomb_state snapshot_get_bomb_sprite(const struct snapshot *snapshot, int x, int y) {
+    assert(snapshot);
+    assert(x >= 0 && x < snapshot->width && y >= 0 && y < snapshot->height);
+
+    return (enum bomb_state) (snapshot->bomb_sprites[x + y * snapshot->width] - 1);
+}
+
+const struct snapshot_entity *snapshot_get_monster(const struct snapshot *snapshot, int x, int y) {
+    assert(snapshot);
+    assert(x >= 0 && x < snapshot->width && y >= 0 && y < snapshot->height);
+
+    int index = snapshot->monster_cells[x + y * snapshot->width];
+
+    return index ? &snapshot->monsters[index - 1] : NULL;
+}
+
+struct snapshot_buffer *snapshot_buffer_new(void) {
+    struct snapshot_buffer *buffer = malloc(sizeof(struct snapshot_buffer));
+
+    if (!buffer) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        buffer->snapshots[i] = snapshot_new();
+    }
+
+    buffer->back = 0;
+    buffer->middle = 1;
+    buffer->front = 2;
+
+    return buffer;
+}
+
+void snapshot_buffer_free(struct snapshot_buffer *buffer) {
+    assert(buffer);
+
+    for (int i = 0; i < 3; i++) {
+        snapshot_free(buffer->snapshots[i]);
+    }
+
+    free(buffer);
+}
+
+struct snapshot *snapshot_buffer_get_back(struct snapshot_buffer *buffer) {
+    assert(buffer);
+
+    return buffer->snapshots[buffer->back];
+}
+
+void snapshot_buffer_publish(struct snapshot_buffer *buffer) {
+    assert(buffer);
+
+    // the back snapshot becomes the middle one, the game goes on with the previous middle one
+    int middle = __atomic_exchange_n(&buffer->middle, buffer->back | FRESH, __ATOMIC_ACQ_REL);
+
+    buffer->back = middle & INDEX_MASK;
+}
+
+const struct snapshot *snapshot_buffer_get_latest(struct snapshot_buffer *buffer) {
+    assert(buffer);
+
+    // without a new snapshot, the display draws the same one again
+    if (__atomic_load_n(&buffer->middle, __ATOMIC_ACQUIRE) & FRESH) {
+        int middle = __atomic_exchange_n(&buffer->middle, buffer->front, __ATOMIC_ACQ_REL);
+
+        buffer->front = middle & INDEX_MASK;
+    }
+
+    return buffer->snapshots[buffer->front];
+}
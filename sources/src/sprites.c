@@ -1,7 +1,13 @@
 #include "../include/sprites.h"
+#include "../include/asset.h"
 #include "../include/misc.h"
+#include "../include/pack.h"
 #include "../include/constant.h"
+#include "../include/window.h"
+#include "../include/blit.h"
 #include <assert.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define MAP_CASE           "sprite/wood_box.png"
 #define MAP_KEY            "sprite/key.png"
@@ -51,130 +57,228 @@
 #define MONSTER_RIGHT   "sprite/monster_right.png"
 #define MONSTER_DOWN    "sprite/monster_down.png"
 
+#define SPRITES_PACK    "sprite/sprites.pack"
+
+/**
+ * @brief Maximum number of sprites packed in the atlas.
+ */
+#define NUM_SPRITES 40
+
+/**
+ * @brief Width (number of pixels) of the sprite atlas.
+ */
+#define ATLAS_WIDTH (10 * SIZE_BLOC)
+
+/**
+ * @brief Maximum number of atlases scaled to another tile size kept at the same time.
+ */
+#define MAX_SCALED_SETS 4
+
+/**
+ * @brief Maximum number of digits of a number drawn in the place of a single digit.
+ */
+#define MAX_NUMBER_DIGITS 10
+
+/**
+ * @brief Structure representing every sprite scaled to a tile size.
+ */
+struct sprite_set {
+    int tile_size; /**< Size of a cell in pixels */
+    SDL_Surface *atlas; /**< Every sprite, scaled to the tile size */
+    SDL_Rect rects[NUM_SPRITES]; /**< Area of each packed sprite in the scaled atlas */
+    struct sprite_set *next; /**< Pointer to the set used less recently */
+};
+
 struct sprites {
-    SDL_Surface *bomb_img[5];
-    SDL_Surface *numbers[10];
-    SDL_Surface *banner_life;
-    SDL_Surface *banner_bomb;
-    SDL_Surface *banner_range;
-    SDL_Surface *banner_line;
-    SDL_Surface *banner_line_vert;
-    SDL_Surface *box;
-    SDL_Surface *key;
-    SDL_Surface *door_opened;
-    SDL_Surface *door_closed;
-    SDL_Surface *stone;
-    SDL_Surface *tree;
-    SDL_Surface *bonus[5];
-    SDL_Surface *player_img[NUM_DIRECTIONS];
-    SDL_Surface *princess;
-    SDL_Surface *monster_img[NUM_DIRECTIONS];
+    struct asset_cache *assets; /**< Cache decoding each image file once */
+    struct pack *pack; /**< Pack the atlas is mapped from, NULL if the images were decoded */
+    SDL_Surface *atlas; /**< Every sprite, packed in a single surface in display format */
+    struct sprite *packed[NUM_SPRITES]; /**< Sprites packed in the atlas, in loading order */
+    const char *paths[NUM_SPRITES]; /**< Image file of each packed sprite */
+    SDL_Rect rects[NUM_SPRITES]; /**< Area of each packed sprite in the atlas */
+    int num_packed; /**< Number of sprites packed in the atlas */
+    int tile_size; /**< Size of a cell in pixels the sprites are currently drawn at */
+    struct sprite_set *scaled_sets; /**< Atlases scaled to other tile sizes, most recently used first */
+    SDL_Surface *digit_strips[MAX_NUMBER_DIGITS + 1]; /**< The ten digits scaled down for each number of digits, NULL until drawn at the tile size */
+    struct sprite small_digits[MAX_NUMBER_DIGITS + 1][10]; /**< Each digit in the strip of each number of digits */
+    struct sprite bomb_img[5];
+    struct sprite numbers[10];
+    struct sprite banner_life;
+    struct sprite banner_bomb;
+    struct sprite banner_range;
+    struct sprite banner_line;
+    struct sprite banner_line_vert;
+    struct sprite box;
+    struct sprite key;
+    struct sprite door_opened;
+    struct sprite door_closed;
+    struct sprite stone;
+    struct sprite tree;
+    struct sprite bonus[5];
+    struct sprite player_img[NUM_DIRECTIONS];
+    struct sprite princess;
+    struct sprite monster_img[NUM_DIRECTIONS];
 };
 
-static void bomb_load(struct sprites *sprites) {
-    sprites->bomb_img[EXPLODING] = image_load(BOMB_EXPLOSION);
-    sprites->bomb_img[TTL1] = image_load(BOMB_TTL1);
-    sprites->bomb_img[TTL2] = image_load(BOMB_TTL2);
-    sprites->bomb_img[TTL3] = image_load(BOMB_TTL3);
-    sprites->bomb_img[TTL4] = image_load(BOMB_TTL4);
+static void sprite_load(struct sprites *sprites, struct sprite *sprite, const char *filename) {
+    assert(sprites);
+    assert(sprite);
+    assert(sprites->num_packed < NUM_SPRITES);
+
+    sprite->surface = NULL;
+
+    sprites->packed[sprites->num_packed] = sprite;
+    sprites->paths[sprites->num_packed] = filename;
+    sprites->num_packed++;
 }
 
-static void bomb_unload(struct sprites *sprites) {
-    for (int i = 0; i < 5; i++) {
-        SDL_FreeSurface(sprites->bomb_img[i]);
-    }
+static void bomb_load(struct sprites *sprites) {
+    sprite_load(sprites, &sprites->bomb_img[EXPLODING], BOMB_EXPLOSION);
+    sprite_load(sprites, &sprites->bomb_img[TTL1], BOMB_TTL1);
+    sprite_load(sprites, &sprites->bomb_img[TTL2], BOMB_TTL2);
+    sprite_load(sprites, &sprites->bomb_img[TTL3], BOMB_TTL3);
+    sprite_load(sprites, &sprites->bomb_img[TTL4], BOMB_TTL4);
 }
 
 static void banner_load(struct sprites *sprites) {
-    sprites->numbers[0] = image_load(DIGIT_0);
-    sprites->numbers[1] = image_load(DIGIT_1);
-    sprites->numbers[2] = image_load(DIGIT_2);
-    sprites->numbers[3] = image_load(DIGIT_3);
-    sprites->numbers[4] = image_load(DIGIT_4);
-    sprites->numbers[5] = image_load(DIGIT_5);
-    sprites->numbers[6] = image_load(DIGIT_6);
-    sprites->numbers[7] = image_load(DIGIT_7);
-    sprites->numbers[8] = image_load(DIGIT_8);
-    sprites->numbers[9] = image_load(DIGIT_9);
-
-    sprites->banner_life = image_load(BANNER_LIFE);
-    sprites->banner_bomb = image_load(BANNER_BOMB);
-    sprites->banner_range = image_load(BANNER_RANGE);
-    sprites->banner_line = image_load(BANNER_LINE);
-    sprites->banner_line_vert = image_load(BANNER_LINE_VERT);
-}
-
-static void banner_unload(struct sprites *sprites) {
-
-    for (int i = 0; i < 10; i++) {
-        SDL_FreeSurface(sprites->numbers[i]);
-    }
-
-    SDL_FreeSurface(sprites->banner_line);
-    SDL_FreeSurface(sprites->banner_line_vert);
-    SDL_FreeSurface(sprites->banner_bomb);
-    SDL_FreeSurface(sprites->banner_range);
-    SDL_FreeSurface(sprites->banner_life);
+    sprite_load(sprites, &sprites->numbers[0], DIGIT_0);
+    sprite_load(sprites, &sprites->numbers[1], DIGIT_1);
+    sprite_load(sprites, &sprites->numbers[2], DIGIT_2);
+    sprite_load(sprites, &sprites->numbers[3], DIGIT_3);
+    sprite_load(sprites, &sprites->numbers[4], DIGIT_4);
+    sprite_load(sprites, &sprites->numbers[5], DIGIT_5);
+    sprite_load(sprites, &sprites->numbers[6], DIGIT_6);
+    sprite_load(sprites, &sprites->numbers[7], DIGIT_7);
+    sprite_load(sprites, &sprites->numbers[8], DIGIT_8);
+    sprite_load(sprites, &sprites->numbers[9], DIGIT_9);
+
+    sprite_load(sprites, &sprites->banner_life, BANNER_LIFE);
+    sprite_load(sprites, &sprites->banner_bomb, BANNER_BOMB);
+    sprite_load(sprites, &sprites->banner_range, BANNER_RANGE);
+    sprite_load(sprites, &sprites->banner_line, BANNER_LINE);
+    sprite_load(sprites, &sprites->banner_line_vert, BANNER_LINE_VERT);
 }
 
 static void map_load(struct sprites *sprites) {
-    sprites->tree = image_load(MAP_TREE);
-    sprites->box = image_load(MAP_CASE);
-    sprites->key = image_load(MAP_KEY);
-    sprites->stone = image_load(MAP_STONE);
-    sprites->door_opened = image_load(MAP_DOOR_OPENED);
-    sprites->door_closed = image_load(MAP_DOOR_CLOSED);
-    sprites->princess = image_load(PRINCESS);
-}
-
-static void map_unload(struct sprites *sprites) {
-    SDL_FreeSurface(sprites->tree);
-    SDL_FreeSurface(sprites->box);
-    SDL_FreeSurface(sprites->key);
-    SDL_FreeSurface(sprites->stone);
-    SDL_FreeSurface(sprites->door_opened);
-    SDL_FreeSurface(sprites->door_closed);
-    SDL_FreeSurface(sprites->princess);
+    sprite_load(sprites, &sprites->tree, MAP_TREE);
+    sprite_load(sprites, &sprites->box, MAP_CASE);
+    sprite_load(sprites, &sprites->key, MAP_KEY);
+    sprite_load(sprites, &sprites->stone, MAP_STONE);
+    sprite_load(sprites, &sprites->door_opened, MAP_DOOR_OPENED);
+    sprite_load(sprites, &sprites->door_closed, MAP_DOOR_CLOSED);
+    sprite_load(sprites, &sprites->princess, PRINCESS);
 }
 
 static void bonus_load(struct sprites *sprites) {
-    sprites->bonus[BONUS_BOMB_RANGE_INC] = image_load(IMG_BONUS_BOMB_RANGE_INC);
-    sprites->bonus[BONUS_BOMB_RANGE_DEC] = image_load(IMG_BONUS_BOMB_RANGE_DEC);
-    sprites->bonus[BONUS_BOMB_NB_INC] = image_load(IMG_BONUS_BOMB_NB_INC);
-    sprites->bonus[BONUS_BOMB_NB_DEC] = image_load(IMG_BONUS_BOMB_NB_DEC);
-    sprites->bonus[BONUS_LIFE] = image_load(IMG_BONUS_LIFE);
+    sprite_load(sprites, &sprites->bonus[BONUS_BOMB_RANGE_INC], IMG_BONUS_BOMB_RANGE_INC);
+    sprite_load(sprites, &sprites->bonus[BONUS_BOMB_RANGE_DEC], IMG_BONUS_BOMB_RANGE_DEC);
+    sprite_load(sprites, &sprites->bonus[BONUS_BOMB_NB_INC], IMG_BONUS_BOMB_NB_INC);
+    sprite_load(sprites, &sprites->bonus[BONUS_BOMB_NB_DEC], IMG_BONUS_BOMB_NB_DEC);
+    sprite_load(sprites, &sprites->bonus[BONUS_LIFE], IMG_BONUS_LIFE);
 }
 
-static void bonus_unload(struct sprites *sprites) {
-    for (int i = 0; i < 5; i++) {
-        SDL_FreeSurface(sprites->bonus[i]);
-    }
+static void player_load(struct sprites *sprites) {
+    sprite_load(sprites, &sprites->player_img[WEST], PLAYER_LEFT);
+    sprite_load(sprites, &sprites->player_img[EAST], PLAYER_RIGHT);
+    sprite_load(sprites, &sprites->player_img[NORTH], PLAYER_UP);
+    sprite_load(sprites, &sprites->player_img[SOUTH], PLAYER_DOWN);
 }
 
-static void player_load(struct sprites *sprites) {
-    sprites->player_img[WEST] = image_load(PLAYER_LEFT);
-    sprites->player_img[EAST] = image_load(PLAYER_RIGHT);
-    sprites->player_img[NORTH] = image_load(PLAYER_UP);
-    sprites->player_img[SOUTH] = image_load(PLAYER_DOWN);
+static void monster_load(struct sprites *sprites) {
+    sprite_load(sprites, &sprites->monster_img[WEST], MONSTER_LEFT);
+    sprite_load(sprites, &sprites->monster_img[EAST], MONSTER_RIGHT);
+    sprite_load(sprites, &sprites->monster_img[NORTH], MONSTER_UP);
+    sprite_load(sprites, &sprites->monster_img[SOUTH], MONSTER_DOWN);
 }
 
+static struct sprite *find_packed_duplicate(struct sprites *sprites, int index) {
+    assert(sprites);
 
-static void player_unload(struct sprites *sprites) {
-    for (int i = 0; i < NUM_DIRECTIONS; i++) {
-        SDL_FreeSurface(sprites->player_img[i]);
+    for (int i = 0; i < index; i++) {
+        if (sprites->packed[i]->surface == sprites->packed[index]->surface) {
+            return sprites->packed[i];
+        }
     }
+
+    return NULL;
 }
 
-static void monster_load(struct sprites *sprites) {
-    sprites->monster_img[WEST] = image_load(MONSTER_LEFT);
-    sprites->monster_img[EAST] = image_load(MONSTER_RIGHT);
-    sprites->monster_img[NORTH] = image_load(MONSTER_UP);
-    sprites->monster_img[SOUTH] = image_load(MONSTER_DOWN);
+static void set_atlas_alpha(SDL_Surface *atlas) {
+    assert(atlas);
+    assert(SDL_GetVideoSurface());
+
+    // the kernels read the pixels of the atlas directly, SDL's blitter skips the transparent runs of an encoded one
+    Uint32 flags = blit_is_supported(atlas, SDL_GetVideoSurface()) ? SDL_SRCALPHA : SDL_SRCALPHA | SDL_RLEACCEL;
+
+    SDL_SetAlpha(atlas, flags, SDL_ALPHA_OPAQUE);
 }
 
-static void monster_unload(struct sprites *sprites) {
-    for (int i = 0; i < NUM_DIRECTIONS; i++) {
-        SDL_FreeSurface(sprites->monster_img[i]);
+static void atlas_build(struct sprites *sprites) {
+    assert(sprites);
+
+    // shelf packing: sprites are laid out left to right, a new shelf starts when a row is full
+    int x = 0;
+    int y = 0;
+    int shelf_height = 0;
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        SDL_Rect *rect = &sprites->packed[i]->rect;
+        struct sprite *duplicate = find_packed_duplicate(sprites, i);
+
+        // sprites sharing the same decoded image share the same area of the atlas
+        if (duplicate) {
+            *rect = duplicate->rect;
+            continue;
+        }
+
+        if (x + rect->w > ATLAS_WIDTH) {
+            x = 0;
+            y += shelf_height;
+            shelf_height = 0;
+        }
+
+        rect->x = (Sint16) x;
+        rect->y = (Sint16) y;
+
+        x += rect->w;
+
+        if (rect->h > shelf_height) {
+            shelf_height = rect->h;
+        }
+    }
+
+    SDL_Surface *raw_atlas = SDL_CreateRGBSurface(SDL_SWSURFACE, ATLAS_WIDTH, y + shelf_height, 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000);
+
+    if (!raw_atlas) {
+        error("Can't create sprite atlas: %s\n", SDL_GetError());
+    }
+
+    SDL_FillRect(raw_atlas, NULL, 0);
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        struct sprite *sprite = sprites->packed[i];
+
+        if (!find_packed_duplicate(sprites, i)) {
+            SDL_Rect place = sprite->rect;
+            Uint32 alpha_flags = sprite->surface->flags & SDL_SRCALPHA;
+            Uint8 alpha = sprite->surface->format->alpha;
+
+            // copy the pixels and their alpha channel as they are instead of blending them
+            SDL_SetAlpha(sprite->surface, 0, SDL_ALPHA_OPAQUE);
+            SDL_BlitSurface(sprite->surface, NULL, raw_atlas, &place);
+            SDL_SetAlpha(sprite->surface, alpha_flags, alpha);
+        }
+    }
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        asset_cache_release(sprites->assets, sprites->packed[i]->surface);
+    }
+
+    sprites->atlas = SDL_DisplayFormatAlpha(raw_atlas);
+    SDL_FreeSurface(raw_atlas);
+
+    if (!sprites->atlas) {
+        error("Can't convert sprite atlas: %s\n", SDL_GetError());
     }
 }
 
@@ -187,17 +291,41 @@ static void sprites_load(struct sprites *sprites) {
     player_load(sprites);
     bomb_load(sprites);
     monster_load(sprites);
-}
 
-static void sprites_unload(struct sprites *sprites) {
-    assert(sprites);
+    sprites->pack = pack_open(SPRITES_PACK, sprites->paths, sprites->num_packed);
+
+    if (sprites->pack) {
+        // the atlas was baked in display format, nothing to decode
+        sprites->atlas = pack_get_atlas(sprites->pack);
+
+        for (int i = 0; i < sprites->num_packed; i++) {
+            sprites->packed[i]->rect = pack_get_rect(sprites->pack, i);
+        }
+    } else {
+        // every image is decoded before the atlas is built
+        asset_cache_preload(sprites->assets, sprites->paths, sprites->num_packed);
 
-    map_unload(sprites);
-    bonus_unload(sprites);
-    banner_unload(sprites);
-    player_unload(sprites);
-    bomb_unload(sprites);
-    monster_unload(sprites);
+        for (int i = 0; i < sprites->num_packed; i++) {
+            struct sprite *sprite = sprites->packed[i];
+
+            sprite->surface = asset_cache_load(sprites->assets, sprites->paths[i]);
+            sprite->rect.x = 0;
+            sprite->rect.y = 0;
+            sprite->rect.w = (Uint16) sprite->surface->w;
+            sprite->rect.h = (Uint16) sprite->surface->h;
+        }
+
+        atlas_build(sprites);
+    }
+
+    set_atlas_alpha(sprites->atlas);
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        sprites->packed[i]->surface = sprites->atlas;
+        sprites->rects[i] = sprites->packed[i]->rect;
+    }
+
+    sprites->tile_size = SIZE_BLOC;
 }
 
 struct sprites *sprites_new() {
@@ -208,111 +336,495 @@ struct sprites *sprites_new() {
         exit(EXIT_FAILURE);
     }
 
+    memset(sprites, 0, sizeof(struct sprites));
+
+    sprites->assets = asset_cache_new();
     sprites_load(sprites);
 
     return sprites;
 }
 
+static void free_digit_strips(struct sprites *sprites) {
+    assert(sprites);
+
+    for (int i = 0; i <= MAX_NUMBER_DIGITS; i++) {
+        if (sprites->digit_strips[i]) {
+            SDL_FreeSurface(sprites->digit_strips[i]);
+            sprites->digit_strips[i] = NULL;
+        }
+    }
+}
+
 void sprites_free(struct sprites *sprites) {
     assert(sprites);
 
-    sprites_unload(sprites);
+    free_digit_strips(sprites);
+
+    struct sprite_set *set = sprites->scaled_sets;
+
+    while (set != NULL) {
+        struct sprite_set *next = set->next;
+        SDL_FreeSurface(set->atlas);
+        free(set);
+        set = next;
+    }
+
+    if (sprites->pack) {
+        pack_close(sprites->pack);
+    } else {
+        SDL_FreeSurface(sprites->atlas);
+    }
+
+    asset_cache_free(sprites->assets);
     free(sprites);
 }
 
-SDL_Surface *sprites_get_number(struct sprites *sprites, int number) {
-    assert(number >= 0 && number <= 9);
-    return sprites->numbers[number];
+size_t sprites_get_resident_memory(struct sprites *sprites) {
+    assert(sprites);
+    assert(sprites->atlas);
+
+    // the decoded images are released once copied to the atlas, the atlas holds every sprite
+    size_t memory = (size_t) sprites->atlas->pitch * sprites->atlas->h;
+
+    for (struct sprite_set *set = sprites->scaled_sets; set != NULL; set = set->next) {
+        memory += (size_t) set->atlas->pitch * set->atlas->h;
+    }
+
+    for (int i = 0; i <= MAX_NUMBER_DIGITS; i++) {
+        if (sprites->digit_strips[i]) {
+            memory += (size_t) sprites->digit_strips[i]->pitch * sprites->digit_strips[i]->h;
+        }
+    }
+
+    return memory;
+}
+
+int sprites_scale_length(int length, int tile_size) {
+    return (length * tile_size + SIZE_BLOC / 2) / SIZE_BLOC;
+}
+
+/**
+ * @brief Resample a line of premultiplied RGBA pixels with an area filter.
+ * Each destination pixel is the average of the source pixels it covers, weighted by their coverage.
+ */
+static void resample_line(const float *src, int src_length, int src_step, float *dst, int dst_length, int dst_step) {
+    double ratio = (double) src_length / dst_length;
+
+    for (int d = 0; d < dst_length; d++) {
+        double start = d * ratio;
+        double end = (d + 1) * ratio;
+        double sum[4] = {0, 0, 0, 0};
+
+        for (int s = (int) start; s < src_length && s < end; s++) {
+            double weight = (s + 1 < end ? s + 1 : end) - (s > start ? s : start);
+            const float *pixel = &src[4 * s * src_step];
+
+            for (int c = 0; c < 4; c++) {
+                sum[c] += weight * pixel[c];
+            }
+        }
+
+        for (int c = 0; c < 4; c++) {
+            dst[4 * d * dst_step + c] = (float) (sum[c] / ratio);
+        }
+    }
+}
+
+static Uint8 to_channel(double value) {
+    return value <= 0 ? 0 : value >= 255 ? 255 : (Uint8) (value + 0.5);
+}
+
+static void scale_sprite(SDL_Surface *src, SDL_Rect *src_rect, SDL_Surface *dst, SDL_Rect *dst_rect) {
+    int w = src_rect->w;
+    int h = src_rect->h;
+    int scaled_w = dst_rect->w;
+    int scaled_h = dst_rect->h;
+
+    if (w == 0 || h == 0 || scaled_w == 0 || scaled_h == 0) {
+        return;
+    }
+
+    float *source = malloc((size_t) w * h * 4 * sizeof(float));
+    float *columns = malloc((size_t) scaled_w * h * 4 * sizeof(float));
+    float *scaled = malloc((size_t) scaled_w * scaled_h * 4 * sizeof(float));
+
+    if (!source || !columns || !scaled) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    // the colors are premultiplied by alpha, so that transparent pixels don't darken the edges
+    for (int y = 0; y < h; y++) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) src->pixels + (size_t) (src_rect->y + y) * src->pitch) + src_rect->x;
+
+        for (int x = 0; x < w; x++) {
+            Uint8 r, g, b, a;
+            float *pixel = &source[4 * (y * w + x)];
+
+            SDL_GetRGBA(row[x], src->format, &r, &g, &b, &a);
+            pixel[0] = r * a / 255.0f;
+            pixel[1] = g * a / 255.0f;
+            pixel[2] = b * a / 255.0f;
+            pixel[3] = a;
+        }
+    }
+
+    for (int y = 0; y < h; y++) {
+        resample_line(&source[4 * y * w], w, 1, &columns[4 * y * scaled_w], scaled_w, 1);
+    }
+
+    for (int x = 0; x < scaled_w; x++) {
+        resample_line(&columns[4 * x], h, scaled_w, &scaled[4 * x], scaled_h, scaled_w);
+    }
+
+    for (int y = 0; y < scaled_h; y++) {
+        Uint32 *row = (Uint32 *) ((Uint8 *) dst->pixels + (size_t) (dst_rect->y + y) * dst->pitch) + dst_rect->x;
+
+        for (int x = 0; x < scaled_w; x++) {
+            float *pixel = &scaled[4 * (y * scaled_w + x)];
+            double alpha = pixel[3];
+            double factor = alpha > 0 ? 255.0 / alpha : 0;
+
+            row[x] = SDL_MapRGBA(dst->format, to_channel(pixel[0] * factor), to_channel(pixel[1] * factor), to_channel(pixel[2] * factor), to_channel(alpha));
+        }
+    }
+
+    free(scaled);
+    free(columns);
+    free(source);
+}
+
+static int is_area_scaled(struct sprites *sprites, int index) {
+    assert(sprites);
+
+    for (int i = 0; i < index; i++) {
+        if (sprites->rects[i].x == sprites->rects[index].x && sprites->rects[i].y == sprites->rects[index].y) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static struct sprite_set *sprite_set_new(struct sprites *sprites, int tile_size) {
+    assert(sprites);
+
+    struct sprite_set *set = malloc(sizeof(struct sprite_set));
+
+    if (!set) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    SDL_PixelFormat *format = sprites->atlas->format;
+
+    set->tile_size = tile_size;
+    set->next = NULL;
+    set->atlas = SDL_CreateRGBSurface(SDL_SWSURFACE, sprites_scale_length(sprites->atlas->w, tile_size), sprites_scale_length(sprites->atlas->h, tile_size), 32, format->Rmask, format->Gmask, format->Bmask, format->Amask);
+
+    if (!set->atlas) {
+        error("Can't create scaled sprite atlas: %s\n", SDL_GetError());
+    }
+
+    SDL_FillRect(set->atlas, NULL, 0);
+
+    if (SDL_LockSurface(sprites->atlas) != 0 || SDL_LockSurface(set->atlas) != 0) {
+        error("Can't lock sprite atlas: %s\n", SDL_GetError());
+    }
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        SDL_Rect *rect = &sprites->rects[i];
+        SDL_Rect *scaled = &set->rects[i];
+
+        // the edges are scaled rather than the sizes, so that neighbouring areas never overlap
+        scaled->x = (Sint16) sprites_scale_length(rect->x, tile_size);
+        scaled->y = (Sint16) sprites_scale_length(rect->y, tile_size);
+        scaled->w = (Uint16) (sprites_scale_length(rect->x + rect->w, tile_size) - scaled->x);
+        scaled->h = (Uint16) (sprites_scale_length(rect->y + rect->h, tile_size) - scaled->y);
+
+        if (!is_area_scaled(sprites, i)) {
+            scale_sprite(sprites->atlas, rect, set->atlas, scaled);
+        }
+    }
+
+    SDL_UnlockSurface(set->atlas);
+    SDL_UnlockSurface(sprites->atlas);
+
+    set_atlas_alpha(set->atlas);
+
+    return set;
+}
+
+static struct sprite_set *find_scaled_set(struct sprites *sprites, int tile_size) {
+    assert(sprites);
+
+    struct sprite_set **link = &sprites->scaled_sets;
+    int num_sets = 0;
+
+    while (*link != NULL && (*link)->tile_size != tile_size) {
+        link = &(*link)->next;
+        num_sets++;
+    }
+
+    struct sprite_set *set = *link;
+
+    if (set) {
+        *link = set->next;
+    } else {
+        set = sprite_set_new(sprites, tile_size);
+
+        // the set used the least recently is dropped, it is the last one of the list
+        if (num_sets == MAX_SCALED_SETS) {
+            struct sprite_set **last = &sprites->scaled_sets;
+
+            while ((*last)->next != NULL) {
+                last = &(*last)->next;
+            }
+
+            SDL_FreeSurface((*last)->atlas);
+            free(*last);
+            *last = NULL;
+        }
+    }
+
+    set->next = sprites->scaled_sets;
+    sprites->scaled_sets = set;
+
+    return set;
+}
+
+void sprites_set_tile_size(struct sprites *sprites, int tile_size) {
+    assert(sprites);
+    assert(tile_size >= MIN_TILE_SIZE && tile_size <= MAX_TILE_SIZE);
+
+    if (tile_size == sprites->tile_size) {
+        return;
+    }
+
+    // the sprites are scaled once per tile size, every frame is then drawn with 1:1 blits
+    if (tile_size == SIZE_BLOC) {
+        for (int i = 0; i < sprites->num_packed; i++) {
+            sprites->packed[i]->surface = sprites->atlas;
+            sprites->packed[i]->rect = sprites->rects[i];
+        }
+    } else {
+        struct sprite_set *set = find_scaled_set(sprites, tile_size);
+
+        for (int i = 0; i < sprites->num_packed; i++) {
+            sprites->packed[i]->surface = set->atlas;
+            sprites->packed[i]->rect = set->rects[i];
+        }
+    }
+
+    // the digit strips are scaled down from the digits of the previous tile size
+    free_digit_strips(sprites);
+
+    sprites->tile_size = tile_size;
+}
+
+int sprites_get_tile_size(struct sprites *sprites) {
+    assert(sprites);
+    return sprites->tile_size;
+}
+
+void sprites_bake_pack(struct sprites *sprites) {
+    assert(sprites);
+    assert(sprites->atlas);
+
+    // the pack holds the sprites at their original size, whatever the current tile size
+    pack_write(SPRITES_PACK, sprites->atlas, sprites->paths, sprites->rects, sprites->num_packed);
+}
+
+void sprites_benchmark(struct sprites *sprites, SDL_Surface *window, int iterations) {
+    assert(sprites);
+    assert(window);
+    assert(iterations > 0);
+
+    Uint32 raw_duration = 0;
+    Uint32 atlas_duration = 0;
+
+    for (int i = 0; i < sprites->num_packed; i++) {
+        SDL_Surface *raw = image_load(sprites->paths[i]);
+
+        Uint32 start = SDL_GetTicks();
+
+        for (int n = 0; n < iterations; n++) {
+            window_display_image(window, raw, 0, 0);
+        }
+
+        raw_duration += SDL_GetTicks() - start;
+        start = SDL_GetTicks();
+
+        for (int n = 0; n < iterations; n++) {
+            window_display_sprite(window, sprites->packed[i], 0, 0);
+        }
+
+        atlas_duration += SDL_GetTicks() - start;
+
+        SDL_FreeSurface(raw);
+    }
+
+    int num_blits = sprites->num_packed * iterations;
+
+    printf("Blit benchmark (%d blits of %d sprites)\n", num_blits, sprites->num_packed);
+    printf("  image_load surfaces : %u ms (%.0f blits/s)\n", raw_duration, raw_duration ? 1000.0 * num_blits / raw_duration : 0.0);
+    printf("  display format atlas: %u ms (%.0f blits/s)\n", atlas_duration, atlas_duration ? 1000.0 * num_blits / atlas_duration : 0.0);
+    printf("  resident atlases    : %lu KiB\n", (unsigned long) (sprites_get_resident_memory(sprites) / 1024));
+    printf("  cached images       : %d, %lu KiB\n", asset_cache_get_num_assets(sprites->assets), (unsigned long) (asset_cache_get_resident_memory(sprites->assets) / 1024));
+}
+
+struct sprite *sprites_get_digit(struct sprites *sprites, int digit) {
+    assert(digit >= 0 && digit <= 9);
+    return &sprites->numbers[digit];
+}
+
+static void digit_strip_build(struct sprites *sprites, int num_digits) {
+    assert(sprites);
+    assert(num_digits > 1 && num_digits <= MAX_NUMBER_DIGITS);
+
+    SDL_Surface *source = sprites->numbers[0].surface;
+    SDL_PixelFormat *format = source->format;
+
+    // the digits keep their proportions, num_digits of them span the width of one
+    int width = sprites->numbers[0].rect.w / num_digits;
+    int height = sprites->numbers[0].rect.h / num_digits;
+
+    SDL_Surface *strip = SDL_CreateRGBSurface(SDL_SWSURFACE, 10 * (width > 0 ? width : 1), height > 0 ? height : 1, 32, format->Rmask, format->Gmask, format->Bmask, format->Amask);
+
+    if (!strip) {
+        error("Can't create digit strip: %s\n", SDL_GetError());
+    }
+
+    SDL_FillRect(strip, NULL, 0);
+
+    if (SDL_LockSurface(source) != 0 || SDL_LockSurface(strip) != 0) {
+        error("Can't lock sprite atlas: %s\n", SDL_GetError());
+    }
+
+    for (int i = 0; i < 10; i++) {
+        struct sprite *digit = &sprites->small_digits[num_digits][i];
+
+        digit->surface = strip;
+        digit->rect.x = (Sint16) (i * width);
+        digit->rect.y = 0;
+        digit->rect.w = (Uint16) width;
+        digit->rect.h = (Uint16) height;
+
+        scale_sprite(source, &sprites->numbers[i].rect, strip, &digit->rect);
+    }
+
+    SDL_UnlockSurface(strip);
+    SDL_UnlockSurface(source);
+
+    set_atlas_alpha(strip);
+
+    sprites->digit_strips[num_digits] = strip;
+}
+
+struct sprite *sprites_get_small_digit(struct sprites *sprites, int digit, int num_digits) {
+    assert(sprites);
+    assert(digit >= 0 && digit <= 9);
+    assert(num_digits > 0 && num_digits <= MAX_NUMBER_DIGITS);
+
+    if (num_digits == 1) {
+        return &sprites->numbers[digit];
+    }
+
+    if (!sprites->digit_strips[num_digits]) {
+        digit_strip_build(sprites, num_digits);
+    }
+
+    return &sprites->small_digits[num_digits][digit];
 }
 
-SDL_Surface *sprites_get_player(struct sprites *sprites, enum direction direction) {
-    assert(sprites->player_img[direction]);
-    return sprites->player_img[direction];
+struct sprite *sprites_get_player(struct sprites *sprites, enum direction direction) {
+    assert(sprites->player_img[direction].surface);
+    return &sprites->player_img[direction];
 }
 
-SDL_Surface *sprites_get_monster(struct sprites *sprites, enum direction direction) {
-    assert(sprites->monster_img[direction]);
-    return sprites->monster_img[direction];
+struct sprite *sprites_get_monster(struct sprites *sprites, enum direction direction) {
+    assert(sprites->monster_img[direction].surface);
+    return &sprites->monster_img[direction];
 }
 
-SDL_Surface *sprites_get_banner_life(struct sprites *sprites) {
-    assert(sprites->banner_life);
-    return sprites->banner_life;
+struct sprite *sprites_get_banner_life(struct sprites *sprites) {
+    assert(sprites->banner_life.surface);
+    return &sprites->banner_life;
 }
 
-SDL_Surface *sprites_get_banner_bomb(struct sprites *sprites) {
-    assert(sprites->banner_bomb);
-    return sprites->banner_bomb;
+struct sprite *sprites_get_banner_bomb(struct sprites *sprites) {
+    assert(sprites->banner_bomb.surface);
+    return &sprites->banner_bomb;
 }
 
-SDL_Surface *sprites_get_banner_line(struct sprites *sprites) {
-    assert(sprites->banner_line);
-    return sprites->banner_line;
+struct sprite *sprites_get_banner_line(struct sprites *sprites) {
+    assert(sprites->banner_line.surface);
+    return &sprites->banner_line;
 }
 
-SDL_Surface *sprites_get_banner_vertical_line(struct sprites *sprites) {
-    assert(sprites->banner_line_vert);
-    return sprites->banner_line_vert;
+struct sprite *sprites_get_banner_vertical_line(struct sprites *sprites) {
+    assert(sprites->banner_line_vert.surface);
+    return &sprites->banner_line_vert;
 }
 
-SDL_Surface *sprites_get_banner_range(struct sprites *sprites) {
-    assert(sprites->banner_range);
-    return sprites->banner_range;
+struct sprite *sprites_get_banner_range(struct sprites *sprites) {
+    assert(sprites->banner_range.surface);
+    return &sprites->banner_range;
 }
 
-SDL_Surface *sprites_get_bonus(struct sprites *sprites, enum bonus_type bonus_type) {
-    assert(sprites->bonus[bonus_type]);
-    return sprites->bonus[bonus_type];
+struct sprite *sprites_get_bonus(struct sprites *sprites, enum bonus_type bonus_type) {
+    assert(sprites->bonus[bonus_type].surface);
+    return &sprites->bonus[bonus_type];
 }
 
-SDL_Surface *sprites_get_box(struct sprites *sprites) {
-    assert(sprites->box);
-    return sprites->box;
+struct sprite *sprites_get_box(struct sprites *sprites) {
+    assert(sprites->box.surface);
+    return &sprites->box;
 }
 
-SDL_Surface *sprites_get_key(struct sprites *sprites) {
-    assert(sprites->key);
-    return sprites->key;
+struct sprite *sprites_get_key(struct sprites *sprites) {
+    assert(sprites->key.surface);
+    return &sprites->key;
 }
 
-SDL_Surface *sprites_get_scenery(struct sprites *sprites, enum scenery_type type) {
+struct sprite *sprites_get_scenery(struct sprites *sprites, enum scenery_type type) {
 
     if (type == SCENERY_STONE) {
-        assert(sprites->stone);
-        return sprites->stone;
+        assert(sprites->stone.surface);
+        return &sprites->stone;
 
     }
 
     if (type == SCENERY_TREE) {
-        assert(sprites->tree);
-        return sprites->tree;
+        assert(sprites->tree.surface);
+        return &sprites->tree;
 
     }
 
     if (type == SCENERY_PRINCESS) {
-        assert(sprites->princess);
-        return sprites->princess;
+        assert(sprites->princess.surface);
+        return &sprites->princess;
     }
 
     return NULL;
 }
 
-SDL_Surface *sprites_get_door(struct sprites *sprites, enum door_status status) {
+struct sprite *sprites_get_door(struct sprites *sprites, enum door_status status) {
 
     if (status == OPENED) {
-        assert(sprites->door_opened);
-        return sprites->door_opened;
+        assert(sprites->door_opened.surface);
+        return &sprites->door_opened;
     }
 
     if (status == CLOSED) {
-        assert(sprites->door_closed);
-        return sprites->door_closed;
+        assert(sprites->door_closed.surface);
+        return &sprites->door_closed;
     }
 
     return NULL;
 }
 
-SDL_Surface *sprites_get_bomb(struct sprites *sprites, enum bomb_state bomb_state) {
-    assert(sprites->bomb_img[bomb_state]);
-    return sprites->bomb_img[bomb_state];
+struct sprite *sprites_get_bomb(struct sprites *sprites, enum bomb_state bomb_state) {
+    assert(sprites->bomb_img[bomb_state].surface);
+    return &sprites->bomb_img[bomb_state];
 }
@@ -0,0 +1,554 @@
+#include "../include/backend.h"
+#include "../include/snapshot.h"
+#include "../include/camera.h"
+#include "../include/misc.h"
+#include "../include/constant.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @brief Number of terminal columns of a cell of the map, so that the cells look square.
+ */
+#define CELL_COLUMNS 2
+
+/**
+ * @brief Maximum size of a character of the terminal in UTF-8, including the terminating null byte.
+ */
+#define CHARACTER_BYTES 5
+
+/**
+ * @brief Maximum number of bytes written for a character: moving the cursor, changing the colors and the character.
+ */
+#define CHARACTER_OUTPUT_BYTES 32
+
+/**
+ * @brief Number of bytes kept from the keyboard, enough for an escape sequence.
+ */
+#define INPUT_BYTES 8
+
+/**
+ * @brief SGR codes of the colors, the background codes are the foreground codes plus 10.
+ */
+enum color {
+    BLACK = 30,
+    RED = 31,
+    GREEN = 32,
+    YELLOW = 33,
+    BLUE = 34,
+    MAGENTA = 35,
+    CYAN = 36,
+    WHITE = 37,
+    DEFAULT = 39,
+    GREY = 90,
+    BRIGHT_RED = 91,
+    BRIGHT_YELLOW = 93,
+    BRIGHT_CYAN = 96,
+    BRIGHT_WHITE = 97
+};
+
+/**
+ * @brief Structure representing a character of the terminal with its colors.
+ */
+struct character {
+    char text[CHARACTER_BYTES]; /**< The character in UTF-8 */
+    unsigned char foreground; /**< Color of the character */
+    unsigned char background; /**< Color behind the character */
+};
+
+/**
+ * @brief Structure representing the state of the terminal backend.
+ */
+struct terminal_backend {
+    FILE *output; /**< Terminal the game is drawn on */
+    struct camera *camera; /**< Camera following the player on the current map */
+    int num_rows; /**< Number of rows of the frame */
+    int num_columns; /**< Number of columns of the frame */
+    struct character *frame; /**< Frame being drawn */
+    struct character *screen; /**< Frame shown by the terminal, the next one only sends what changed */
+    char *buffer; /**< Bytes sent to the terminal for a frame */
+    int cursor_row; /**< Row of the cursor of the terminal */
+    int cursor_column; /**< Column of the cursor of the terminal */
+    unsigned char foreground; /**< Current foreground color of the terminal */
+    unsigned char background; /**< Current background color of the terminal */
+    Uint32 next_frame; /**< Time of the next frame to draw */
+    int num_frames; /**< Number of frames drawn */
+    unsigned long num_bytes; /**< Number of bytes sent to the terminal */
+    int reads_keys; /**< Are the commands read from the keyboard ? */
+    struct termios saved_termios; /**< Settings of the keyboard to restore */
+    char input[INPUT_BYTES]; /**< Bytes read from the keyboard and not yet turned into commands */
+    int input_length; /**< Number of bytes in input */
+};
+
+/**
+ * @brief Characters of the bonuses, indexed by bonus type.
+ */
+static const char *bonus_glyphs[NUM_BONUS_TYPES] = {
+    [BONUS_BOMB_RANGE_DEC] = "««",
+    [BONUS_BOMB_RANGE_INC] = "»»",
+    [BONUS_BOMB_NB_DEC] = "●-",
+    [BONUS_BOMB_NB_INC] = "●+",
+    [BONUS_LIFE] = "♥+",
+    [BONUS_MONSTER] = "!!"
+};
+
+/**
+ * @brief Characters of the bombs, indexed by bomb state.
+ */
+static const char *bomb_glyphs[INIT] = {
+    [EXPLODING] = "░░",
+    [TTL1] = "●1",
+    [TTL2] = "●2",
+    [TTL3] = "●3",
+    [TTL4] = "●4"
+};
+
+/**
+ * @brief Characters of the player, indexed by direction.
+ */
+static const char *player_glyphs[NUM_DIRECTIONS] = {
+    [NORTH] = "▲ ",
+    [EAST] = "► ",
+    [SOUTH] = "▼ ",
+    [WEST] = "◄ "
+};
+
+static int get_character_length(const char *text) {
+    unsigned char first = (unsigned char) text[0];
+
+    if (first < 0x80) {
+        return 1;
+    } else if ((first & 0xe0) == 0xc0) {
+        return 2;
+    } else if ((first & 0xf0) == 0xe0) {
+        return 3;
+    }
+
+    return 4;
+}
+
+static void draw_text(struct terminal_backend *backend, int row, int column, const char *text, enum color foreground, enum color background) {
+    assert(backend);
+    assert(text);
+
+    while (*text && column < backend->num_columns) {
+        int length = get_character_length(text);
+        struct character *character = &backend->frame[row * backend->num_columns + column];
+
+        memset(character->text, 0, CHARACTER_BYTES);
+        memcpy(character->text, text, length);
+        character->foreground = (unsigned char) foreground;
+        character->background = (unsigned char) (background + 10);
+
+        text += length;
+        column++;
+    }
+}
+
+static void draw_cell(struct terminal_backend *backend, const struct snapshot *snapshot, int x, int y) {
+    assert(backend);
+    assert(snapshot);
+
+    int row = y - camera_get_y(backend->camera);
+    int column = (x - camera_get_x(backend->camera)) * CELL_COLUMNS;
+    unsigned char type = snapshot_get_cell_value(snapshot, x, y);
+
+    switch ((enum cell_type) (type & 0xf0)) {
+        case CELL_SCENERY:
+            if ((type & 0x0f) == SCENERY_STONE) {
+                draw_text(backend, row, column, "██", GREY, DEFAULT);
+            } else if ((type & 0x0f) == SCENERY_TREE) {
+                draw_text(backend, row, column, "♣♣", GREEN, DEFAULT);
+            } else {
+                draw_text(backend, row, column, "♛ ", MAGENTA, DEFAULT);
+            }
+
+            break;
+
+        case CELL_BOX:
+            draw_text(backend, row, column, "▒▒", YELLOW, DEFAULT);
+            break;
+
+        case CELL_BONUS:
+            draw_text(backend, row, column, bonus_glyphs[(type & 0x0f) % NUM_BONUS_TYPES], BRIGHT_WHITE, BLUE);
+            break;
+
+        case CELL_KEY:
+            draw_text(backend, row, column, "◊ ", BRIGHT_YELLOW, DEFAULT);
+            break;
+
+        case CELL_DOOR:
+            draw_text(backend, row, column, (type & 0x01) == CLOSED ? "▐▌" : "[]", (type & 0x01) == CLOSED ? RED : GREEN, DEFAULT);
+            break;
+
+        default:
+            draw_text(backend, row, column, "  ", DEFAULT, DEFAULT);
+            break;
+    }
+
+    enum bomb_state bomb = snapshot_get_bomb_sprite(snapshot, x, y);
+
+    if (bomb == EXPLODING) {
+        draw_text(backend, row, column, bomb_glyphs[EXPLODING], BRIGHT_YELLOW, RED);
+    } else if (bomb != DONE) {
+        draw_text(backend, row, column, bomb_glyphs[bomb], BRIGHT_RED, DEFAULT);
+    }
+}
+
+static void draw_entity(struct terminal_backend *backend, const struct snapshot_entity *entity, const char *glyph, enum color color) {
+    assert(backend);
+    assert(entity);
+
+    // the moves aren't interpolated, an entity is on a single cell
+    if (camera_is_visible(backend->camera, entity->x, entity->y)) {
+        int row = entity->y - camera_get_y(backend->camera);
+        int column = (entity->x - camera_get_x(backend->camera)) * CELL_COLUMNS;
+
+        draw_text(backend, row, column, glyph, color, DEFAULT);
+    }
+}
+
+static void draw_banner(struct terminal_backend *backend, const struct snapshot *snapshot) {
+    assert(backend);
+    assert(snapshot);
+
+    char text[64];
+
+    snprintf(text, sizeof(text), " L%d  ♥%d  ●%d  »%d  ◊%d", snapshot->level + 1, snapshot->num_lives, snapshot->num_bombs, snapshot->range_bombs, snapshot->num_keys);
+
+    int row = backend->num_rows - 1;
+
+    for (int column = 0; column < backend->num_columns; column++) {
+        draw_text(backend, row, column, " ", BRIGHT_WHITE, BLUE);
+    }
+
+    draw_text(backend, row, 0, text, BRIGHT_WHITE, BLUE);
+}
+
+static char *write_character(struct terminal_backend *backend, char *output, int row, int column, struct character *character) {
+    assert(backend);
+    assert(output);
+    assert(character);
+
+    // the cursor only moves when the changed characters aren't next to each other
+    if (row != backend->cursor_row || column != backend->cursor_column) {
+        output += sprintf(output, "\033[%d;%dH", row + 1, column + 1);
+    }
+
+    if (character->foreground != backend->foreground || character->background != backend->background) {
+        output += sprintf(output, "\033[%d;%dm", character->foreground, character->background);
+        backend->foreground = character->foreground;
+        backend->background = character->background;
+    }
+
+    output += sprintf(output, "%s", character->text);
+
+    backend->cursor_row = row;
+    backend->cursor_column = column + 1;
+
+    return output;
+}
+
+static void send_changes(struct terminal_backend *backend) {
+    assert(backend);
+
+    char *output = backend->buffer;
+
+    for (int row = 0; row < backend->num_rows; row++) {
+        for (int column = 0; column < backend->num_columns; column++) {
+            struct character *character = &backend->frame[row * backend->num_columns + column];
+            struct character *shown = &backend->screen[row * backend->num_columns + column];
+
+            if (memcmp(character, shown, sizeof(struct character)) != 0) {
+                output = write_character(backend, output, row, column, character);
+                *shown = *character;
+            }
+        }
+    }
+
+    if (output == backend->buffer) {
+        return;
+    }
+
+    // the messages of the game are printed below the frame, in the default colors
+    output += sprintf(output, "\033[0m\033[%d;1H", backend->num_rows + 1);
+    backend->foreground = DEFAULT;
+    backend->background = DEFAULT + 10;
+    backend->cursor_row = backend->num_rows;
+    backend->cursor_column = 0;
+
+    fwrite(backend->buffer, 1, output - backend->buffer, backend->output);
+    fflush(backend->output);
+
+    backend->num_bytes += (unsigned long) (output - backend->buffer);
+}
+
+static void read_keys(struct terminal_backend *backend) {
+    assert(backend);
+
+    struct termios termios;
+
+    if (!isatty(STDIN_FILENO) || tcgetattr(STDIN_FILENO, &backend->saved_termios) != 0) {
+        return;
+    }
+
+    // the keys come without waiting for a line feed, and reading doesn't block when none was pressed
+    termios = backend->saved_termios;
+    termios.c_lflag &= ~(ICANON | ECHO);
+    termios.c_iflag &= ~(IXON | ICRNL);
+    termios.c_cc[VMIN] = 0;
+    termios.c_cc[VTIME] = 0;
+
+    if (tcsetattr(STDIN_FILENO, TCSANOW, &termios) == 0) {
+        backend->reads_keys = 1;
+    }
+}
+
+static void *terminal_open(struct game *game, const char *argument) {
+    assert(game);
+
+    struct terminal_backend *backend = malloc(sizeof(struct terminal_backend));
+
+    if (!backend) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(backend, 0, sizeof(struct terminal_backend));
+
+    backend->output = argument ? fopen(argument, "w") : stdout;
+
+    if (!backend->output) {
+        error("Can't open terminal %s\n", argument);
+    }
+
+    backend->camera = camera_new(VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    backend->num_rows = VIEWPORT_HEIGHT + 1;
+    backend->num_columns = VIEWPORT_WIDTH * CELL_COLUMNS;
+
+    int num_characters = backend->num_rows * backend->num_columns;
+
+    backend->frame = malloc(num_characters * sizeof(struct character));
+    backend->screen = malloc(num_characters * sizeof(struct character));
+    backend->buffer = malloc(num_characters * CHARACTER_OUTPUT_BYTES + CHARACTER_OUTPUT_BYTES);
+
+    if (!backend->frame || !backend->screen || !backend->buffer) {
+        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
+        exit(EXIT_FAILURE);
+    }
+
+    // the terminal starts cleared, in the default colors
+    backend->foreground = DEFAULT;
+    backend->background = DEFAULT + 10;
+
+    for (int i = 0; i < num_characters; i++) {
+        memset(&backend->screen[i], 0, sizeof(struct character));
+        backend->screen[i].text[0] = ' ';
+        backend->screen[i].foreground = DEFAULT;
+        backend->screen[i].background = DEFAULT + 10;
+    }
+
+    fprintf(backend->output, "\033[0m\033[2J\033[?25l");
+    fflush(backend->output);
+
+    // only the terminal the game was started from is read, a remote one only watches
+    if (!argument) {
+        read_keys(backend);
+    }
+
+    return backend;
+}
+
+static void terminal_close(void *data) {
+    struct terminal_backend *backend = data;
+
+    assert(backend);
+
+    if (backend->reads_keys) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &backend->saved_termios);
+    }
+
+    fprintf(backend->output, "\033[0m\033[?25h\033[%d;1H", backend->num_rows + 1);
+
+    if (backend->output != stdout) {
+        fclose(backend->output);
+    } else {
+        fflush(backend->output);
+    }
+
+    printf("Terminal: %d frames, %lu bytes, %.1f bytes per frame\n", backend->num_frames, backend->num_bytes, backend->num_frames ? (double) backend->num_bytes / backend->num_frames : 0.0);
+
+    camera_free(backend->camera);
+    free(backend->frame);
+    free(backend->screen);
+    free(backend->buffer);
+    free(backend);
+}
+
+static void terminal_display(void *data, const struct snapshot *snapshot, double alpha) {
+    struct terminal_backend *backend = data;
+
+    assert(backend);
+    assert(snapshot);
+
+    (void) alpha;
+
+    // along with a faster backend, the terminal keeps its own rate
+    Uint32 ticks = SDL_GetTicks();
+
+    if (backend->num_frames > 0 && (Sint32) (ticks - backend->next_frame) < 0) {
+        return;
+    }
+
+    backend->next_frame += 1000 / DEFAULT_TERMINAL_FPS;
+
+    if ((Sint32) (ticks - backend->next_frame) >= 0) {
+        backend->next_frame = ticks + 1000 / DEFAULT_TERMINAL_FPS;
+    }
+
+    camera_follow(backend->camera, snapshot->width, snapshot->height, snapshot->player.x, snapshot->player.y);
+
+    // the characters out of a map smaller than the viewport are blank
+    for (int row = 0; row < backend->num_rows - 1; row++) {
+        for (int column = 0; column < backend->num_columns; column++) {
+            draw_text(backend, row, column, " ", DEFAULT, DEFAULT);
+        }
+    }
+
+    int first_x = camera_get_x(backend->camera);
+    int first_y = camera_get_y(backend->camera);
+
+    for (int x = first_x; x < first_x + camera_get_width(backend->camera); x++) {
+        for (int y = first_y; y < first_y + camera_get_height(backend->camera); y++) {
+            draw_cell(backend, snapshot, x, y);
+
+            const struct snapshot_entity *monster = snapshot_get_monster(snapshot, x, y);
+
+            if (monster) {
+                draw_entity(backend, monster, "☻ ", RED);
+            }
+        }
+    }
+
+    draw_entity(backend, &snapshot->player, player_glyphs[snapshot->player.direction], BRIGHT_CYAN);
+
+    draw_banner(backend, snapshot);
+
+    send_changes(backend);
+
+    backend->num_frames++;
+}
+
+static void terminal_pump(void *data) {
+    (void) data;
+}
+
+static enum action get_key_action(char key) {
+    switch (key) {
+        case ' ':
+            return ACTION_BOMB;
+
+        case '\r':
+        case '\n':
+            return ACTION_OPEN;
+
+        case 'p':
+            return ACTION_PAUSE;
+
+        case 'b':
+            return ACTION_BACK;
+
+        case 'f':
+            return ACTION_FORWARD;
+
+        case 'q':
+            return ACTION_QUIT;
+
+        // ctrl + s
+        case 0x13:
+            return ACTION_SAVE;
+
+        default:
+            return ACTION_NONE;
+    }
+}
+
+static enum action get_arrow_action(char key) {
+    switch (key) {
+        case 'A':
+            return ACTION_NORTH;
+
+        case 'B':
+            return ACTION_SOUTH;
+
+        case 'C':
+            return ACTION_EAST;
+
+        case 'D':
+            return ACTION_WEST;
+
+        default:
+            return ACTION_NONE;
+    }
+}
+
+static enum action terminal_poll(void *data, Uint64 *time) {
+    struct terminal_backend *backend = data;
+
+    assert(backend);
+    assert(time);
+
+    // the keys are read when the game asks for them
+    *time = get_monotonic_time();
+
+    if (!backend->reads_keys) {
+        return ACTION_NONE;
+    }
+
+    ssize_t num_read = read(STDIN_FILENO, backend->input + backend->input_length, INPUT_BYTES - backend->input_length);
+
+    if (num_read > 0) {
+        backend->input_length += (int) num_read;
+    }
+
+    while (backend->input_length > 0) {
+        enum action action;
+        int length = 1;
+
+        if (backend->input[0] != '\033') {
+            action = get_key_action(backend->input[0]);
+        } else if (backend->input_length < 3) {
+            // the rest of an arrow comes with the next read, a lone escape is dropped
+            if (num_read > 0) {
+                return ACTION_NONE;
+            }
+
+            action = ACTION_NONE;
+        } else {
+            action = backend->input[1] == '[' ? get_arrow_action(backend->input[2]) : ACTION_NONE;
+            length = 3;
+        }
+
+        backend->input_length -= length;
+        memmove(backend->input, backend->input + length, backend->input_length);
+
+        if (action != ACTION_NONE) {
+            return action;
+        }
+    }
+
+    return ACTION_NONE;
+}
+
+const struct backend terminal_backend = {
+    SDL_INIT_TIMER,
+    DEFAULT_TERMINAL_FPS,
+    terminal_open,
+    terminal_close,
+    terminal_display,
+    terminal_pump,
+    terminal_poll
+};
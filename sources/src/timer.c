@@ -13,6 +13,27 @@ struct timer {
     int remaining;         /**< The remaining time of the timer. */
 };
 
+/**
+ * @brief Time of the game in milliseconds, since the start of the process.
+ */
+static long current_time = 0;
+
+void timer_advance_clock(int duration) {
+    assert(duration >= 0);
+
+    current_time += duration;
+}
+
+long timer_get_clock(void) {
+    return current_time;
+}
+
+void timer_set_clock(long time) {
+    assert(time >= 0);
+
+    current_time = time;
+}
+
 struct timer *timer_new() {
     struct timer *timer = malloc(sizeof(struct timer));
 
@@ -33,35 +54,50 @@ void timer_free(struct timer *timer) {
     free(timer);
 }
 
-void timer_write(struct timer *timer, FILE *file) {
+void timer_serialize(struct timer *timer, struct buffer *buffer) {
     assert(timer);
-    assert(file);
+    assert(buffer);
 
-    fwrite(timer, sizeof(struct timer), 1, file);
+    buffer_write_int(buffer, timer->duration);
+    buffer_write_int(buffer, timer->is_over);
+    buffer_write_int(buffer, timer->remaining);
+
+    // the elapsed time is kept exactly, the timer goes on from there on the clock of its reader
+    buffer_write_int(buffer, (int) (current_time - timer->start_time));
 }
 
-struct timer *timer_read(FILE *file) {
-    assert(file);
+struct timer *timer_deserialize(struct buffer *buffer) {
+    assert(buffer);
 
-    struct timer *timer = malloc(sizeof(struct timer));
+    struct timer *timer = timer_new();
 
-    if (!timer) {
-        fprintf(stderr, "Malloc failed line %d, file %s", __LINE__, __FILE__);
-        exit(EXIT_FAILURE);
-    }
+    timer->duration = buffer_read_int(buffer);
+    timer->is_over = buffer_read_int(buffer);
+    timer->remaining = buffer_read_int(buffer);
+    timer->start_time = current_time - buffer_read_int(buffer);
 
-    fread(timer, sizeof(struct timer), 1, file);
+    return timer;
+}
 
-    timer->start_time = SDL_GetTicks() - (timer->duration - timer->remaining);
+void timer_checkpoint(struct timer *timer, struct buffer *buffer) {
+    assert(timer);
+    assert(buffer);
 
-    return timer;
+    buffer_write_bytes(buffer, timer, sizeof(struct timer));
+}
+
+void timer_rollback(struct timer *timer, struct buffer *buffer) {
+    assert(timer);
+    assert(buffer);
+
+    buffer_read_bytes(buffer, timer, sizeof(struct timer));
 }
 
 void timer_start(struct timer *timer, int duration) {
     assert(timer);
 
     timer->duration = duration;
-    timer->start_time = SDL_GetTicks();
+    timer->start_time = current_time;
     timer->is_over = 0;
     timer->remaining = timer->duration;
 }
@@ -69,7 +105,7 @@ void timer_start(struct timer *timer, int duration) {
 void timer_update(struct timer *timer) {
     assert(timer);
 
-    if ((timer->remaining = timer->duration - (int) (SDL_GetTicks() - timer->start_time)) < 0) {
+    if ((timer->remaining = timer->duration - (int) (current_time - timer->start_time)) < 0) {
         timer->is_over = 1;
     }
 }
@@ -84,6 +120,11 @@ int timer_get_duration(struct timer *timer) {
     return timer->duration;
 }
 
+int timer_get_elapsed(struct timer *timer) {
+    assert(timer);
+    return (int) (current_time - timer->start_time);
+}
+
 void timer_set_start_time(struct timer *timer, long start_time) {
     assert(timer);
     timer->start_time = start_time;
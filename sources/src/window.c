@@ -1,6 +1,7 @@
 #include "../include/window.h"
 #include "../include/constant.h"
 #include "../include/misc.h"
+#include "../include/blit.h"
 #include <assert.h>
 #include <stdlib.h>
 
@@ -18,16 +19,52 @@ SDL_Surface *window_create(int width, int height) {
     return window;
 }
 
+SDL_Surface *window_resize(SDL_Surface *window, int width, int height) {
+    assert(window);
+
+    if (window->w == width && window->h == height) {
+        return window;
+    }
+
+    return window_create(width, height);
+}
+
 void window_display_image(SDL_Surface *window, SDL_Surface *sprite, int x, int y) {
     assert(window);
     assert(sprite);
 
+    struct sprite whole;
+
+    whole.surface = sprite;
+    whole.rect.x = 0;
+    whole.rect.y = 0;
+    whole.rect.w = (Uint16) sprite->w;
+    whole.rect.h = (Uint16) sprite->h;
+
+    window_display_sprite(window, &whole, x, y);
+}
+
+void window_display_sprite(SDL_Surface *window, struct sprite *sprite, int x, int y) {
+    assert(window);
+    assert(sprite);
+
+    // surfaces of the same format go through the vectorized kernels
+    if (blit_is_supported(sprite->surface, window) && (!SDL_MUSTLOCK(window) || SDL_LockSurface(window) == 0)) {
+        blit_sprite(window, &window->clip_rect, sprite, x, y);
+
+        if (SDL_MUSTLOCK(window)) {
+            SDL_UnlockSurface(window);
+        }
+
+        return;
+    }
+
     SDL_Rect place;
 
     place.x = (Sint16) x;
     place.y = (Sint16) y;
 
-    SDL_BlitSurface(sprite, NULL, window, &place);
+    SDL_BlitSurface(sprite->surface, &sprite->rect, window, &place);
 }
 
 void window_clear(SDL_Surface *window) {